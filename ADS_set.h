@@ -1,778 +1,3959 @@
-#ifndef ADS_SET_H
-#define ADS_SET_H
-
-#include <algorithm>
-#include <functional>
-#include <iostream>
-
-#if defined(DEBUG)
-#define TRACE(msg) std::cerr << msg << std::endl;
-#define TRACE_IF(condition, msg) \
-    if (condition) { \
-        TRACE(msg) \
-    }
-#else
-#define TRACE(msg)
-#define TRACE_IF(condition, msg)
-#endif
-
-template<typename Key, size_t N = 3>
-class ADS_set {
-    public:
-        class Iterator;
-        using value_type = Key;
-        using key_type = Key;
-        using reference = value_type &;
-        using const_reference = const value_type &;
-        using size_type = size_t;
-        using difference_type = std::ptrdiff_t;
-        using const_iterator = Iterator;
-        using iterator = Iterator;
-        using key_compare = std::less<key_type>;
-        using key_equal = std::equal_to<key_type>;
-
-    private:
-        enum class InsertMsg {
-            SUCCESS,
-            EXISTS,
-            SPLIT
-        };
-
-        enum class EraseMsg {
-            SUCCESS,
-            NOT_EXISTENT,
-            MERGE
-        };
-
-        enum class MergeDirection {
-            LEFT,
-            RIGHT
-        };
-
-        enum class NodeType {
-            INTERNAL,
-            EXTERNAL
-        };
-
-        struct Node {
-                static constexpr size_type max_size {N * 2};
-                static constexpr size_type min_size {N};
-                key_type *values;
-                size_type node_size;
-
-                // size of the value array so that an additional key has place right before split
-                Node(): values {new key_type[max_size + 1]}, node_size {0} {};
-
-                virtual ~Node() {
-                    delete[] values;
-                };
-
-                virtual void split(size_type) = 0;
-
-                virtual InsertMsg add_elem(const key_type &) = 0;
-
-                virtual NodeType type() const = 0;
-
-                virtual bool count(const key_type &) const = 0;
-
-                virtual iterator find(const key_type &key) const = 0;
-
-                virtual EraseMsg remove_elem(const key_type &) = 0;
-
-                virtual void dump(std::ostream &, size_t) const = 0;
-        };
-
-        struct ExternalNode : public Node {
-                ExternalNode *left_neighbour;
-                ExternalNode *right_neighbour;
-
-                ExternalNode(): Node(), left_neighbour {nullptr}, right_neighbour {nullptr} {}
-
-                ExternalNode(ExternalNode *left_neighbour, ExternalNode *right_neighbour)
-                    : Node(), left_neighbour {left_neighbour}, right_neighbour {right_neighbour} {}
-
-                void split(size_type) override {
-                    TRACE("Something went wrong! (Split was called in External Node!)");
-                }
-
-                NodeType type() const override {
-                    return NodeType::EXTERNAL;
-                }
-
-                bool count(const key_type &elem) const override {
-                    if (find_pos(elem) == -1) {
-                        return false;
-                    }
-                    return true;
-                }
-
-                int find_pos(const key_type &elem) const {
-                    if (this->node_size == 0) {
-                        return -1;
-                    }
-                    int low {0};
-                    int high {static_cast<int>(this->node_size) - 1};
-                    while (low <= high) {
-                        int mid = low + (high - low) / 2;
-                        if (key_equal {}(this->values[mid], elem)) {
-                            return mid;
-                        }
-                        if (key_compare {}(this->values[mid], elem)) {
-                            low = mid + 1;
-                        } else {
-                            high = mid - 1;
-                        }
-                    }
-
-                    return -1;
-                }
-
-                iterator find(const key_type &elem) const override {
-                    if (this->node_size == 0) {
-                        return Iterator();
-                    }
-                    int i {find_pos(elem)};
-                    if (i != -1) {
-                        return Iterator(this, i);
-                    }
-                    return Iterator();
-                }
-
-                InsertMsg add_elem(const key_type &elem) override {
-                    if (find_pos(elem) != -1) {
-                        return InsertMsg::EXISTS;
-                    }
-                    size_type i {0};
-                    for (; i < this->node_size; ++i) {
-                        if (key_compare {}(elem, this->values[i])) {
-                            break;
-                        }
-                    }
-                    for (size_type j {this->node_size}; j > i; --j) {
-                        this->values[j] = this->values[j - 1];
-                    }
-                    this->values[i] = elem;
-                    if (++this->node_size > this->max_size) {
-                        return InsertMsg::SPLIT;
-                    }
-                    return InsertMsg::SUCCESS;
-                }
-
-                EraseMsg remove_elem(const key_type &elem) override {
-                    const int i {find_pos(elem)};
-                    if (i == -1) {
-                        return EraseMsg::NOT_EXISTENT;
-                    }
-                    size_type pos {static_cast<size_type>(i)};
-                    for (; pos < this->node_size - 1; ++pos) {
-                        this->values[pos] = this->values[pos + 1];
-                    }
-                    if (--this->node_size < this->min_size) {
-                        return EraseMsg::MERGE;
-                    }
-                    return EraseMsg::SUCCESS;
-                }
-
-                void dump(std::ostream &o, const size_t n) const override {
-                    for (size_t s {0}; s < n; ++s) {
-                        o << "    ";
-                    }
-                    o << "Leaf: [";
-                    if (this->node_size > 0) {
-                        o << this->values[0];
-                        for (size_t i {1}; i < this->node_size; ++i) {
-                            o << ", " << this->values[i];
-                        }
-                    }
-
-                    o << ']' << std::endl;
-                }
-        };
-
-        struct InternalNode : public Node {
-                Node **children;
-
-                // size of children array +2 so that node can have 1 key too much right before split
-                InternalNode(): Node(), children {new Node *[Node::max_size + 2]} {}
-
-                ~InternalNode() override {
-                    for (size_t i {0}; i <= this->node_size; ++i) {
-                        delete children[i];
-                    }
-                    delete[] children;
-                }
-
-                NodeType type() const override {
-                    return NodeType::INTERNAL;
-                }
-
-                size_type find_pos(key_type elem) const {
-                    size_type i {0};
-                    while (i < this->node_size) {
-                        if (key_compare {}(elem, this->values[i])) {
-                            return i;
-                        }
-                        ++i;
-                    }
-                    return i;
-                }
-
-                bool count(const key_type &key) const override {
-                    return this->children[find_pos(key)]->count(key);
-                }
-
-                iterator find(const key_type &key) const override {
-                    return this->children[find_pos(key)]->find(key);
-                }
-
-                InsertMsg add_elem(const key_type &elem) override {
-                    size_type pos {find_pos(elem)};
-
-                    TRACE_IF(pos > this->node_size, "InternalNode::find_pos malfunctioned!");
-
-                    InsertMsg result {children[pos]->add_elem(elem)};
-                    if (result == InsertMsg::SPLIT) {
-                        split(pos);
-                        if (this->node_size <= this->max_size) {
-                            result = InsertMsg::SUCCESS;
-                        }
-                    }
-                    return result;
-                }
-
-                void split(size_type pos) override {
-                    size_type e {0};
-                    switch (this->children[pos]->type()) {
-                        case NodeType::EXTERNAL:
-
-                            // construct right part
-                            ExternalNode *right_split_e;
-                            right_split_e = new ExternalNode {dynamic_cast<ExternalNode *>(this->children[pos]),
-                                                              dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour};
-                            for (; e <= this->children[pos]->node_size / 2; ++e) {
-                                right_split_e->values[e] = this->children[pos]->values[e + this->children[pos]->node_size / 2];
-                            }
-                            right_split_e->node_size = e;
-
-                            // cut left part
-                            this->children[pos]->node_size /= 2;
-
-                            // manage leaf chaining
-                            if (dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour != nullptr) {
-                                dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour->left_neighbour = right_split_e;
-                            }
-                            dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour = right_split_e;
-
-                            // insert new node
-                            for (size_type i {this->node_size}; i > pos; --i) {
-                                this->values[i] = this->values[i - 1];
-                                this->children[i + 1] = this->children[i];
-                            }
-                            this->values[pos] = right_split_e->values[0];
-                            this->children[pos + 1] = std::move(right_split_e);
-                            ++this->node_size;
-                            break;
-
-                        case NodeType::INTERNAL:
-
-                            // new key
-                            key_type new_key {this->children[pos]->values[this->children[pos]->node_size / 2]};
-
-                            // construct right part
-                            InternalNode *right_split_i {new InternalNode()};
-                            size_type i {0};
-                            for (; i < this->children[pos]->node_size / 2; ++i) {
-                                right_split_i->children[i]
-                                    = dynamic_cast<InternalNode *>(this->children[pos])->children[i + this->children[pos]->node_size / 2 + 1];
-                                right_split_i->values[i] = this->children[pos]->values[i + this->children[pos]->node_size / 2 + 1];
-                            }
-                            right_split_i->children[i]
-                                = dynamic_cast<InternalNode *>(this->children[pos])->children[i + this->children[pos]->node_size / 2 + 1];
-                            right_split_i->node_size = i;
-
-                            // cut left part
-                            this->children[pos]->node_size /= 2;
-
-                            // insert new node
-                            for (size_type j {this->node_size}; j > pos; --j) {
-                                this->values[j] = this->values[j - 1];
-                                this->children[j + 1] = this->children[j];
-                            }
-                            this->values[pos] = std::move(new_key);
-                            this->children[pos + 1] = std::move(right_split_i);
-                            ++this->node_size;
-                            break;
-                    }
-                }
-
-                EraseMsg remove_elem(const key_type &elem) override {
-                    size_type pos {find_pos(elem)};
-
-                    TRACE_IF(pos > this->node_size, "InternalNode::find_pos malfunctioned!");
-
-                    EraseMsg result {this->children[pos]->remove_elem(elem)};
-                    if (result == EraseMsg::MERGE) {
-                        merge(pos);
-                        if (this->node_size >= this->min_size) {
-                            result = EraseMsg::SUCCESS;
-                        }
-                    }
-                    return result;
-                }
-
-                void merge(size_type pos) {
-                    MergeDirection direction; // -1 für links, +1 für rechts
-                    if (pos == this->node_size || (pos != 0 && this->children[pos - 1]->node_size < this->children[pos + 1]->node_size)) {
-                        direction = MergeDirection::LEFT;
-                    } else {
-                        direction = MergeDirection::RIGHT;
-                    }
-                    // try and move one key
-                    if (this->children[pos]->type() == NodeType::EXTERNAL) {
-                        if ((pos == 0 || (direction == MergeDirection::LEFT && pos < this->node_size))
-                            && this->children[pos + 1]->node_size > this->min_size) {
-                            this->children[pos]->values[this->children[pos]->node_size] = this->children[pos + 1]->values[0];
-                            for (size_type i {0}; i < this->children[pos + 1]->node_size; ++i) {
-                                this->children[pos + 1]->values[i] = this->children[pos + 1]->values[i + 1];
-                            }
-                            ++this->children[pos]->node_size;
-                            --this->children[pos + 1]->node_size;
-                            this->values[pos] = this->children[pos + 1]->values[0];
-                            TRACE_IF(this->children[pos]->node_size < this->min_size,
-                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
-                            return;
-                        }
-                        if ((pos == this->node_size || (direction == MergeDirection::RIGHT && pos > 0))
-                            && this->children[pos - 1]->node_size > this->min_size) {
-                            for (size_type i {this->children[pos]->node_size}; i-- > 0;) {
-                                this->children[pos]->values[i + 1] = this->children[pos]->values[i];
-                            }
-                            this->children[pos]->values[0] = this->children[pos - 1]->values[this->children[pos - 1]->node_size - 1];
-                            ++this->children[pos]->node_size;
-                            --this->children[pos - 1]->node_size;
-                            this->values[pos - 1] = this->children[pos]->values[0];
-                            TRACE_IF(this->children[pos]->node_size < this->min_size,
-                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
-                            return;
-                        }
-                    } else {
-                        if ((pos == 0 || (direction == MergeDirection::LEFT && pos < this->node_size))
-                            && this->children[pos + 1]->node_size > this->min_size) {
-                            // move key and child into node at pos (key in parent goes to pos and first key in pos+1 goes in parent
-                            this->children[pos]->values[this->children[pos]->node_size] = this->values[pos];
-                            this->values[pos] = this->children[pos + 1]->values[0];
-                            dynamic_cast<InternalNode *>(this->children[pos])->children[this->children[pos]->node_size + 1]
-                                = dynamic_cast<InternalNode *>(this->children[pos + 1])->children[0];
-                            // restructure node at pos+1; one child ahead because there is 1 more child than keys
-                            dynamic_cast<InternalNode *>(this->children[pos + 1])->children[0]
-                                = dynamic_cast<InternalNode *>(this->children[pos + 1])->children[1];
-                            for (size_type i {0}; i < this->children[pos + 1]->node_size; ++i) {
-                                this->children[pos + 1]->values[i] = this->children[pos + 1]->values[i + 1];
-                                dynamic_cast<InternalNode *>(this->children[pos + 1])->children[i + 1]
-                                    = dynamic_cast<InternalNode *>(this->children[pos + 1])->children[i + 2];
-                            }
-                            // manage node sizes
-                            ++this->children[pos]->node_size;
-                            --this->children[pos + 1]->node_size;
-                            TRACE_IF(this->children[pos]->node_size < this->min_size,
-                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
-                            return;
-                        }
-                        if ((pos == this->node_size || (direction == MergeDirection::RIGHT && pos > 0))
-                            && this->children[pos - 1]->node_size > this->min_size) {
-                            // restructure node at pos; one child ahead because there is 1 more child than keys
-                            dynamic_cast<InternalNode *>(this->children[pos])->children[this->children[pos]->node_size + 1]
-                                = dynamic_cast<InternalNode *>(this->children[pos])->children[this->children[pos]->node_size];
-                            for (size_type i {this->children[pos]->node_size}; i-- > 0;) {
-                                this->children[pos]->values[i + 1] = this->children[pos]->values[i];
-                                dynamic_cast<InternalNode *>(this->children[pos])->children[i + 1]
-                                    = dynamic_cast<InternalNode *>(this->children[pos])->children[i];
-                            }
-                            // move key and child into node at pos (key in parent goes to pos and last key in pos-1 goes to parent
-                            this->children[pos]->values[0] = this->values[pos - 1];
-                            this->values[pos - 1] = this->children[pos - 1]->values[this->children[pos - 1]->node_size - 1];
-                            dynamic_cast<InternalNode *>(this->children[pos])->children[0]
-                                = dynamic_cast<InternalNode *>(this->children[pos - 1])->children[this->children[pos - 1]->node_size];
-                            // manage node sizes
-                            ++this->children[pos]->node_size;
-                            --this->children[pos - 1]->node_size;
-                            TRACE_IF(this->children[pos]->node_size < this->min_size,
-                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
-                            return;
-                        }
-                    }
-                    size_t i_left {0};
-                    size_t j_left {pos};
-                    size_t i_right {0};
-                    size_t j_right {pos + 1};
-                    switch (direction) {
-                        case MergeDirection::LEFT:
-                            TRACE_IF(this->children[pos]->node_size + this->children[pos + 1]->node_size > this->max_size + this->min_size,
-                                     "You messed up merged node is too big!");
-                            // move keys and children
-                            switch (this->children[pos]->type()) {
-                                case NodeType::EXTERNAL:
-                                    for (; i_left < this->children[pos]->node_size; ++i_left) {
-                                        this->children[pos - 1]->values[i_left + this->children[pos - 1]->node_size]
-                                            = this->children[pos]->values[i_left];
-                                    }
-                                    // update leaf chaining
-                                    dynamic_cast<ExternalNode *>(this->children[pos - 1])->right_neighbour
-                                        = dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour;
-                                    if (dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour) {
-                                        dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour->left_neighbour
-                                            = dynamic_cast<ExternalNode *>(this->children[pos - 1]);
-                                    }
-                                    // update size
-                                    this->children[pos - 1]->node_size += this->children[pos]->node_size;
-                                    break;
-
-                                case NodeType::INTERNAL:
-                                    this->children[pos - 1]->values[i_right + this->children[pos - 1]->node_size] = this->values[pos - 1];
-                                    for (; i_left < this->children[pos]->node_size; ++i_left) {
-                                        this->children[pos - 1]->values[i_left + this->children[pos - 1]->node_size + 1]
-                                            = this->children[pos]->values[i_left];
-                                        dynamic_cast<InternalNode *>(this->children[pos - 1])
-                                            ->children[i_left + this->children[pos - 1]->node_size + 1]
-                                            = dynamic_cast<InternalNode *>(this->children[pos])->children[i_left];
-                                    }
-                                    dynamic_cast<InternalNode *>(this->children[pos - 1])->children[i_left + this->children[pos - 1]->node_size + 1]
-                                        = dynamic_cast<InternalNode *>(this->children[pos])->children[i_left];
-                                    // update size
-                                    this->children[pos - 1]->node_size += this->children[pos]->node_size + 1; // +1 because of pulled down value
-                            }
-
-                            // delete old stuff
-                            if (this->children[pos]->type() == NodeType::EXTERNAL) {
-                                delete children[pos];
-                            } else {
-                                children[pos]->node_size = 0;
-                                dynamic_cast<InternalNode *>(children[pos])->children[0] = nullptr;
-                                delete children[pos];
-                            }
-
-                            // reorganize parent node
-                            for (; j_left < this->node_size - 1; ++j_left) {
-                                this->values[j_left - 1] = this->values[j_left];
-                                children[j_left] = this->children[j_left + 1];
-                            }
-                            this->children[j_left] = this->children[j_left + 1];
-                            --this->node_size;
-                            if (this->children[pos - 1]->node_size > this->max_size) {
-                                TRACE_IF(this->children[pos - 1]->node_size > this->max_size + 1,
-                                         "Split was called in a merg with node_size > 2k+1!");
-                                split(pos - 1);
-                            }
-                            break;
-
-                        case MergeDirection::RIGHT:
-                            TRACE_IF(this->children[pos]->node_size + this->children[pos + 1]->node_size > this->max_size + this->min_size,
-                                     "You messed up merged node is too big!");
-                            // move keys and children
-                            switch (this->children[pos]->type()) {
-                                case NodeType::EXTERNAL:
-                                    for (; i_right < this->children[pos + 1]->node_size; ++i_right) {
-                                        this->children[pos]->values[i_right + this->children[pos]->node_size]
-                                            = this->children[pos + 1]->values[i_right];
-                                    }
-                                    // update leaf chaining
-                                    dynamic_cast<ExternalNode *>(this->children[pos])->right_neighbour
-                                        = dynamic_cast<ExternalNode *>(this->children[pos + 1])->right_neighbour;
-                                    if (dynamic_cast<ExternalNode *>(this->children[pos + 1])->right_neighbour) {
-                                        dynamic_cast<ExternalNode *>(this->children[pos + 1])->right_neighbour->left_neighbour
-                                            = dynamic_cast<ExternalNode *>(this->children[pos]);
-                                    }
-                                    // update size
-                                    this->children[pos]->node_size += this->children[pos + 1]->node_size;
-                                    break;
-                                case NodeType::INTERNAL:
-                                    /* this statement is because when an internal node is merged the key in parent which
-                                      will be discarded needs to be pulled down into the merged node */
-                                    this->children[pos]->values[i_right + this->children[pos]->node_size] = this->values[pos];
-                                    // move rest of the stuff
-                                    for (; i_right < this->children[pos + 1]->node_size; ++i_right) {
-                                        this->children[pos]->values[i_right + this->children[pos]->node_size + 1]
-                                            = this->children[pos + 1]->values[i_right];
-                                        dynamic_cast<InternalNode *>(this->children[pos])->children[i_right + this->children[pos]->node_size + 1]
-                                            = dynamic_cast<InternalNode *>(this->children[pos + 1])->children[i_right];
-                                    }
-                                    // move last child as well
-                                    dynamic_cast<InternalNode *>(this->children[pos])->children[i_right + this->children[pos]->node_size + 1]
-                                        = dynamic_cast<InternalNode *>(this->children[pos + 1])->children[i_right];
-                                    // update size
-                                    this->children[pos]->node_size += this->children[pos + 1]->node_size + 1; // +1 because of pulled down value
-                            }
-
-                            // delete old stuff
-                            if (this->children[pos]->type() == NodeType::EXTERNAL) {
-                                delete children[pos + 1];
-                            } else {
-                                children[pos + 1]->node_size = 0;
-                                dynamic_cast<InternalNode *>(children[pos + 1])->children[0] = nullptr;
-                                delete children[pos + 1];
-                            }
-                            // reorganize parent node
-                            for (; j_right < this->node_size; ++j_right) {
-                                this->values[j_right - 1] = this->values[j_right];
-                                this->children[j_right] = this->children[j_right + 1];
-                            }
-                            this->children[j_right] = this->children[j_right + 1];
-                            --this->node_size;
-                            if (this->children[pos]->node_size > this->max_size) {
-                                TRACE_IF(this->children[pos]->node_size > this->max_size + 1, "Split was called in a merg with node_size > 2k+1!");
-                                split(pos);
-                            }
-                    }
-                }
-
-                void dump(std::ostream &o, const size_t n) const override {
-                    for (size_t s {0}; s < n; ++s) {
-                        o << "    ";
-                    }
-                    o << "Internal[";
-                    if (this->node_size > 0) {
-                        o << this->values[0];
-                        for (size_t i {1}; i < this->node_size; ++i) {
-                            o << ", " << this->values[i];
-                        }
-                    }
-
-                    o << "]" << std::endl;
-                    for (size_t i {0}; i < this->node_size + 1; ++i) {
-                        this->children[i]->dump(o, n + 1);
-                    }
-                }
-        };
-
-        size_type sz;
-        Node *root;
-        ExternalNode *left_leaf;
-
-    public:
-        ADS_set(): sz {0}, root {new ExternalNode()}, left_leaf {nullptr} {
-            left_leaf = dynamic_cast<ExternalNode *>(root);
-        }
-
-        ADS_set(std::initializer_list<key_type> ilist): ADS_set() {
-            for (const auto &elem: ilist) {
-                insert(elem);
-            }
-        }
-
-        template<typename InputIt>
-        ADS_set(InputIt first, InputIt last): ADS_set() {
-            for (; first != last; ++first) {
-                insert(*first);
-            }
-        }
-
-        ADS_set(const ADS_set &other): ADS_set() {
-            insert(other.begin(), other.end());
-        }
-
-        ~ADS_set() {
-            delete root;
-        };
-
-        ADS_set &operator=(const ADS_set &other) {
-            clear();
-            insert(other.begin(), other.end());
-            return *this;
-        }
-
-        ADS_set &operator=(std::initializer_list<key_type> ilist) {
-            clear();
-            insert(ilist);
-            return *this;
-        }
-
-        size_type size() const {
-            return sz;
-        }
-
-        bool empty() const {
-            return sz == 0;
-        }
-
-        void insert(std::initializer_list<key_type> ilist) {
-            for (const auto &elem: ilist) {
-                insert(elem);
-            }
-        }
-
-        std::pair<iterator, bool> insert(const key_type &key) {
-            switch (root->add_elem(key)) {
-                case InsertMsg::EXISTS:
-                    TRACE("Existing Element found")
-                    return std::pair<iterator, bool> {find(key), false};
-                case InsertMsg::SUCCESS:
-                    ++sz;
-                    return std::pair<iterator, bool> {find(key), true};
-                case InsertMsg::SPLIT:
-                    InternalNode *new_root;
-                    new_root = new InternalNode();
-                    new_root->children[0] = root;
-                    root = new_root;
-                    root->split(0);
-                    ++sz;
-                    return std::pair<iterator, bool> {find(key), true};
-            }
-            TRACE("You messed up big time! (ADS_set::insert(key) got to the end!)");
-            return std::pair<iterator, bool> {Iterator(), true}; // will never be reached
-        }
-
-        template<typename InputIt>
-        void insert(InputIt first, InputIt last) {
-            for (; first != last; ++first) {
-                insert(*first);
-            }
-        }
-
-        void clear() {
-            delete root;
-            sz = 0;
-            root = new ExternalNode();
-            left_leaf = dynamic_cast<ExternalNode *>(root);
-        }
-
-        size_type erase(const key_type &key) {
-            switch (root->remove_elem(key)) {
-                case EraseMsg::SUCCESS:
-                    --sz;
-                    return 1;
-                case EraseMsg::NOT_EXISTENT:
-                    return 0;
-                case EraseMsg::MERGE:
-                    if (root->type() == NodeType::INTERNAL && root->node_size == 0) {
-                        Node *new_root = dynamic_cast<InternalNode *>(root)->children[0];
-                        dynamic_cast<InternalNode *>(root)->children[0] = nullptr;
-                        delete root;
-                        root = new_root;
-                    }
-                    --sz;
-                    return 1;
-            }
-            return 2; // should never be reached
-        }
-
-        size_type count(const key_type &key) const {
-            if (root->count(key)) {
-                return 1;
-            }
-            return 0;
-        }
-
-        iterator find(const key_type &key) const {
-            return root->find(key);
-        }
-
-        void swap(ADS_set &other) {
-            std::swap(this->root, other.root);
-            std::swap(this->sz, other.sz);
-            std::swap(this->left_leaf, other.left_leaf);
-        }
-
-        const_iterator begin() const {
-            if (sz == 0) {
-                return Iterator();
-            }
-            return Iterator(left_leaf, 0);
-        }
-
-        const_iterator end() const {
-            return Iterator();
-        }
-
-        void dump(std::ostream &o = std::cerr, size_t n = 0) const {
-            o << "Size: " << sz << std::endl;
-            o << "Root ";
-            root->dump(o, n);
-            o << std::endl << "Left ";
-            left_leaf->dump(o, 0);
-        }
-
-        bool operator==(const ADS_set &rhs) const {
-            if (this->sz != rhs.sz) {
-                return false;
-            }
-            auto lit {this->begin()};
-            auto rit {rhs.begin()};
-            while (lit != this->end()) {
-                if (!key_equal {}(*lit, *rit)) {
-                    return false;
-                }
-                ++lit;
-                ++rit;
-            }
-            return true;
-        }
-
-        bool operator!=(const ADS_set &rhs) const {
-            return !(*this == rhs);
-        }
-};
-
-template<typename Key, size_t N>
-class ADS_set<Key, N>::Iterator {
-    public:
-        using value_type = Key;
-        using difference_type = std::ptrdiff_t;
-        using reference = const value_type &;
-        using pointer = const value_type *;
-        using iterator_category = std::forward_iterator_tag;
-
-    private:
-        const ExternalNode *current_node;
-        size_type current_element;
-
-    public:
-        Iterator(): current_node {nullptr}, current_element {0} {}
-
-        Iterator(const ExternalNode *current_node, const size_type current_element): current_node {current_node}, current_element {current_element} {}
-
-        reference operator*() const {
-            return current_node->values[current_element];
-        }
-
-        pointer operator->() const {
-            return &current_node->values[current_element];
-        }
-
-        Iterator &operator++() {
-            if (current_node == nullptr) {
-                return *this;
-            }
-            if (++current_element >= current_node->node_size) {
-                current_node = current_node->right_neighbour;
-                current_element = 0;
-            }
-            return *this;
-        }
-
-        Iterator operator++(int) {
-            if (current_node == nullptr) {
-                return *this;
-            }
-            Iterator copy{this->current_node,this->current_element};
-            if (++current_element >= current_node->node_size) {
-                current_node = current_node->right_neighbour;
-                current_element = 0;
-            }
-            return copy;
-        }
-
-        bool operator==(const Iterator &rhs) const {
-            return this->current_node == rhs.current_node && this->current_element == rhs.current_element;
-        }
-
-        bool operator!=(const Iterator &rhs) const {
-            return this->current_node != rhs.current_node || this->current_element != rhs.current_element;
-        }
-};
-
-template<typename Key, size_t N>
-void swap(ADS_set<Key, N> &lhs, ADS_set<Key, N> &rhs) {
-    lhs.swap(rhs);
-}
-
-#endif // ADS_set
\ No newline at end of file
+#ifndef ADS_SET_H
+#define ADS_SET_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(DEBUG)
+#define TRACE(msg) std::cerr << msg << std::endl;
+#define TRACE_IF(condition, msg) \
+    if (condition) { \
+        TRACE(msg) \
+    }
+#else
+#define TRACE(msg)
+#define TRACE_IF(condition, msg)
+#endif
+
+// in-node search of arithmetic keys uses the compiler's vector extensions,
+// which map to SSE2/AVX2/AVX-512 on x86 and NEON on ARM depending on the target flags
+#if defined(__GNUC__) || defined(__clang__)
+#define ADS_SET_SIMD 1
+#if defined(__AVX512F__)
+#define ADS_SET_SIMD_BYTES 64
+#elif defined(__AVX2__)
+#define ADS_SET_SIMD_BYTES 32
+#else
+#define ADS_SET_SIMD_BYTES 16
+#endif
+#else
+#define ADS_SET_SIMD 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ADS_SET_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define ADS_SET_PREFETCH(address)
+#endif
+
+// saved images are mapped with mmap where POSIX has it, everywhere else ADS_set::open_mapped reads them into memory
+#if defined(__unix__) || defined(__APPLE__)
+#define ADS_SET_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define ADS_SET_MMAP 0
+#endif
+
+// with ADS_SET_STATS=1 every set counts its splits, merges, borrows and lookups for stats() unless set_stats(false)
+// switched it off; without it the counters and the code updating them do not exist
+#if !defined(ADS_SET_STATS)
+#define ADS_SET_STATS 0
+#endif
+#if ADS_SET_STATS
+#define ADS_SET_COUNT(tree, counter, n) \
+    ((tree).counters.counting ? static_cast<void>((tree).counters.counter.fetch_add(n, std::memory_order_relaxed)) : static_cast<void>(0))
+#else
+#define ADS_SET_COUNT(tree, counter, n)
+#endif
+
+// chunks behind ADS_pool_allocator: single objects come as fixed size blocks carved out of large chunks and go back to
+// a free list per block size; release() hands all chunks back at once
+template<size_t ChunkSize>
+class ADS_pool_arena {
+    public:
+        static constexpr size_t block_alignment {64};
+
+    private:
+        struct Slab {
+                size_t block_size;
+                void *free_list;
+                std::byte *next;
+                std::byte *end;
+        };
+
+        std::vector<void *> chunks;
+        std::vector<Slab> slabs;
+
+        Slab &slab_for(const size_t block_size) {
+            for (Slab &slab: slabs) {
+                if (slab.block_size == block_size) {
+                    return slab;
+                }
+            }
+            return slabs.emplace_back(Slab {block_size, nullptr, nullptr, nullptr});
+        }
+
+    public:
+        ADS_pool_arena() = default;
+        ADS_pool_arena(const ADS_pool_arena &) = delete;
+        ADS_pool_arena &operator=(const ADS_pool_arena &) = delete;
+
+        ~ADS_pool_arena() {
+            release();
+        }
+
+        void *allocate(size_t bytes) {
+            const size_t block_size {(bytes + block_alignment - 1) / block_alignment * block_alignment};
+            Slab &slab {slab_for(block_size)};
+            if (slab.free_list != nullptr) {
+                void *block {slab.free_list};
+                slab.free_list = *static_cast<void **>(block);
+                return block;
+            }
+            if (slab.next == slab.end) {
+                const size_t chunk_size {std::max(ChunkSize / block_size, size_t {1}) * block_size};
+                chunks.reserve(chunks.size() + 1);
+                slab.next = static_cast<std::byte *>(::operator new(chunk_size, std::align_val_t {block_alignment}));
+                slab.end = slab.next + chunk_size;
+                chunks.push_back(slab.next);
+            }
+            void *block {slab.next};
+            slab.next += block_size;
+            return block;
+        }
+
+        void deallocate(void *block, size_t bytes) {
+            Slab &slab {slab_for((bytes + block_alignment - 1) / block_alignment * block_alignment)};
+            *static_cast<void **>(block) = slab.free_list;
+            slab.free_list = block;
+        }
+
+        // frees every chunk, all blocks handed out so far become invalid
+        void release() {
+            for (void *chunk: chunks) {
+                ::operator delete(chunk, std::align_val_t {block_alignment});
+            }
+            chunks.clear();
+            slabs.clear();
+        }
+};
+
+// node pool for ADS_set. copies share one arena, a copied set gets an arena of its own
+// (select_on_container_copy_construction). the arena is not synchronized
+template<typename T, size_t ChunkSize = 64 * 1024>
+class ADS_pool_allocator {
+    private:
+        template<typename, size_t>
+        friend class ADS_pool_allocator;
+
+        std::shared_ptr<ADS_pool_arena<ChunkSize>> arena;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        template<typename U>
+        struct rebind {
+                using other = ADS_pool_allocator<U, ChunkSize>;
+        };
+
+        ADS_pool_allocator(): arena {std::make_shared<ADS_pool_arena<ChunkSize>>()} {}
+
+        template<typename U>
+        ADS_pool_allocator(const ADS_pool_allocator<U, ChunkSize> &other) noexcept: arena {other.arena} {}
+
+        T *allocate(const size_t n) {
+            static_assert(alignof(T) <= ADS_pool_arena<ChunkSize>::block_alignment, "ADS_pool_allocator: type is over-aligned");
+            if (n != 1) {
+                return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t {alignof(T)}));
+            }
+            return static_cast<T *>(arena->allocate(sizeof(T)));
+        }
+
+        void deallocate(T *p, const size_t n) noexcept {
+            if (n != 1) {
+                ::operator delete(p, std::align_val_t {alignof(T)});
+                return;
+            }
+            arena->deallocate(p, sizeof(T));
+        }
+
+        ADS_pool_allocator select_on_container_copy_construction() const {
+            return ADS_pool_allocator();
+        }
+
+        // true if no other allocator shares the pool, so release() cannot pull memory from under anybody else
+        bool exclusive() const noexcept {
+            return arena.use_count() == 1;
+        }
+
+        void release() {
+            arena->release();
+        }
+
+        template<typename U>
+        bool operator==(const ADS_pool_allocator<U, ChunkSize> &rhs) const noexcept {
+            return arena == rhs.arena;
+        }
+
+        template<typename U>
+        bool operator!=(const ADS_pool_allocator<U, ChunkSize> &rhs) const noexcept {
+            return arena != rhs.arena;
+        }
+};
+
+// Ranked keeps the number of keys below every child in the internal nodes, which enables rank(), select() and
+// distance() in O(log n); without it the nodes stay as they are.
+// Compare is default constructed wherever keys are compared, so it must not carry state. a transparent Compare
+// (one with is_transparent, like std::less<>) enables lookups with any type it compares against keys
+template<typename Key, size_t N = 3, typename Allocator = std::allocator<Key>, bool Ranked = false, typename Compare = std::less<Key>>
+class ADS_set {
+    public:
+        class Iterator;
+        class Range;
+        class Snapshot;
+        class SnapshotIterator;
+        class Mapped;
+        class Packed;
+        class PackedIterator;
+        using value_type = Key;
+        using key_type = Key;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using const_iterator = Iterator;
+        using iterator = Iterator;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using reverse_iterator = const_reverse_iterator;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using key_equal = std::equal_to<key_type>;
+        using allocator_type = Allocator;
+
+        // tag for inputs that are already strictly ascending (sorted and free of duplicates)
+        struct sorted_unique_t {
+                explicit sorted_unique_t() = default;
+        };
+        static constexpr sorted_unique_t sorted_unique {};
+
+        // shape of the tree and, with ADS_SET_STATS, what it went through; see stats()
+        struct Stats {
+                size_type size;
+                // levels from the root (height 1 is a single leaf) and the nodes on each of them, root first
+                size_type height;
+                std::vector<size_type> nodes_per_level;
+                // average keys per leaf relative to max_size
+                double leaf_fill;
+                // bytes of all nodes, including the ones shared with snapshots
+                size_type bytes;
+                // ADS_SET_STATS only, 0 otherwise: node splits, fusions of two siblings, key moves between siblings, descents
+                // to a leaf and the binary search comparisons made on them
+                size_type splits;
+                size_type merges;
+                size_type borrows;
+                size_type lookups;
+                size_type comparisons;
+        };
+
+        // tag for inputs in any order that are sorted, deduplicated and loaded by several threads
+        struct parallel_t {
+                unsigned threads;
+
+                explicit parallel_t(const unsigned workers = std::thread::hardware_concurrency()): threads {workers} {}
+        };
+
+    private:
+        static_assert(std::is_default_constructible_v<key_compare>, "ADS_set constructs its Compare on demand");
+
+        // lookups take K when it is key_type or when key_compare is transparent
+        template<typename K, typename C = key_compare, typename = void>
+        struct lookup_with : std::is_same<K, key_type> {};
+        template<typename K, typename C>
+        struct lookup_with<K, C, std::void_t<typename C::is_transparent>> : std::true_type {};
+        template<typename K>
+        using if_lookup_with = std::enable_if_t<lookup_with<K>::value, int>;
+
+        enum class InsertMsg {
+            SUCCESS,
+            EXISTS,
+            SPLIT
+        };
+
+        enum class EraseMsg {
+            SUCCESS,
+            NOT_EXISTENT,
+            MERGE
+        };
+
+        enum class MergeDirection {
+            LEFT,
+            RIGHT
+        };
+
+        static constexpr bool branchless_search {(std::is_arithmetic_v<key_type> || std::is_pointer_v<key_type> || std::is_enum_v<key_type>)
+                                                 && (std::is_same_v<key_compare, std::less<key_type>> || std::is_same_v<key_compare, std::less<>>)};
+        static constexpr bool simd_search {ADS_SET_SIMD && branchless_search && std::is_arithmetic_v<key_type> && !std::is_same_v<key_type, bool>
+                                           && sizeof(key_type) <= 8};
+
+        enum class SetOperation {
+            UNION,
+            INTERSECTION,
+            DIFFERENCE
+        };
+
+        enum class NodeType {
+            INTERNAL,
+            EXTERNAL
+        };
+
+        struct ExternalNode;
+        struct InternalNode;
+
+        // nodes carry their type as a plain field, so traversal needs neither virtual calls nor RTTI;
+        // keys (and children) are stored inline so that every node is one cache line aligned allocation
+        struct alignas(64) Node {
+                static constexpr size_type max_size {N * 2};
+                static constexpr size_type min_size {N};
+                const NodeType type;
+                // links to this node from parents, the root pointer and snapshots; sits in the padding next to type
+                std::atomic<std::uint32_t> refs;
+                size_type node_size;
+                InternalNode *parent;
+                // size of the value array so that an additional key has place right before split
+                key_type values[max_size + 1];
+
+                explicit Node(const NodeType node_type): type {node_type}, refs {1}, node_size {0}, parent {nullptr} {};
+
+                bool is_leaf() const {
+                    return type == NodeType::EXTERNAL;
+                }
+
+                // first slot for which goes_right is false; it has to hold for a prefix of the keys only.
+                // one comparison per step, scalar keys take the branchless variant (compiles to cmov)
+                template<typename Pred>
+                size_type partition_point(Pred goes_right) const {
+                    if constexpr (branchless_search) {
+                        if (node_size == 0) {
+                            return 0;
+                        }
+                        const key_type *base {values};
+                        size_type len {node_size};
+                        while (len > 1) {
+                            const size_type half {len / 2};
+                            base = goes_right(base[half]) ? base + half : base;
+                            len -= half;
+                        }
+                        return static_cast<size_type>(base - values) + (goes_right(*base) ? 1 : 0);
+                    } else {
+                        return static_cast<size_type>(std::partition_point(values, values + node_size, goes_right) - values);
+                    }
+                }
+
+#if ADS_SET_SIMD
+                // narrows the range branchlessly until a few vectors are left, then counts the keys that go right
+                template<bool upper>
+                size_type simd_bound(const key_type &key) const {
+                    typedef key_type vector __attribute__((vector_size(ADS_SET_SIMD_BYTES)));
+                    constexpr size_type lanes {ADS_SET_SIMD_BYTES / sizeof(key_type)};
+                    const key_type *base {values};
+                    size_type len {node_size};
+                    while (len > 4 * lanes) {
+                        const size_type half {len / 2};
+                        base = (upper ? !(key < base[half]) : base[half] < key) ? base + half : base;
+                        len -= half;
+                    }
+                    vector probe {};
+                    probe += key;
+                    decltype(probe < probe) hits {};
+                    size_type i {0};
+                    for (; i + lanes <= len; i += lanes) {
+                        vector block;
+                        std::memcpy(&block, base + i, sizeof(block));
+                        hits += upper ? block <= probe : block < probe; // lanes that hit are -1
+                    }
+                    size_type count {0};
+                    for (size_type l {0}; l < lanes; ++l) {
+                        count -= static_cast<size_type>(hits[l]);
+                    }
+                    for (; i < len; ++i) {
+                        count += upper ? !(key < base[i]) : base[i] < key;
+                    }
+                    return static_cast<size_type>(base - values) + count;
+                }
+#endif
+
+                // first slot whose key is not less than key
+                template<typename K>
+                size_type lower_bound(const K &key) const {
+#if ADS_SET_SIMD
+                    if constexpr (simd_search && std::is_same_v<K, key_type>) {
+                        return simd_bound<false>(key);
+                    }
+#endif
+                    return partition_point([&key](const key_type &value) { return key_compare {}(value, key); });
+                }
+
+                // first slot whose key is greater than key
+                template<typename K>
+                size_type upper_bound(const K &key) const {
+#if ADS_SET_SIMD
+                    if constexpr (simd_search && std::is_same_v<K, key_type>) {
+                        return simd_bound<true>(key);
+                    }
+#endif
+                    return partition_point([&key](const key_type &value) { return !key_compare {}(key, value); });
+                }
+
+                static void dump(const Node *node, std::ostream &o, const size_t n) {
+                    if (node->is_leaf()) {
+                        static_cast<const ExternalNode *>(node)->dump(o, n);
+                    } else {
+                        static_cast<const InternalNode *>(node)->dump(o, n);
+                    }
+                }
+        };
+
+        struct ExternalNode : public Node {
+                ExternalNode *left_neighbour;
+                ExternalNode *right_neighbour;
+
+                ExternalNode(): Node(NodeType::EXTERNAL), left_neighbour {nullptr}, right_neighbour {nullptr} {}
+
+                ExternalNode(ExternalNode *left, ExternalNode *right): Node(NodeType::EXTERNAL), left_neighbour {left}, right_neighbour {right} {}
+
+                template<typename K>
+                int find_pos(const K &elem) const {
+                    const size_type i {this->lower_bound(elem)};
+                    if (i < this->node_size && !key_compare {}(elem, this->values[i])) {
+                        return static_cast<int>(i);
+                    }
+                    return -1;
+                }
+
+                // slot reports where the key ended up or was found; elem is only moved from if it goes in.
+                // shifts move the keys, which is a memmove for trivially copyable ones
+                template<typename K>
+                InsertMsg add_elem(K &&elem, size_type &slot) {
+                    const size_type i {this->lower_bound(elem)};
+                    if (i < this->node_size && !key_compare {}(elem, this->values[i])) {
+                        slot = i;
+                        return InsertMsg::EXISTS;
+                    }
+                    std::move_backward(this->values + i, this->values + this->node_size, this->values + this->node_size + 1);
+                    this->values[i] = std::forward<K>(elem);
+                    slot = i;
+                    if (++this->node_size > this->max_size) {
+                        return InsertMsg::SPLIT;
+                    }
+                    return InsertMsg::SUCCESS;
+                }
+
+                EraseMsg remove_elem(const key_type &elem) {
+                    const int i {find_pos(elem)};
+                    if (i == -1) {
+                        return EraseMsg::NOT_EXISTENT;
+                    }
+                    return remove_at(static_cast<size_type>(i));
+                }
+
+                EraseMsg remove_at(const size_type pos) {
+                    std::move(this->values + pos + 1, this->values + this->node_size, this->values + pos);
+                    if (--this->node_size < this->min_size) {
+                        return EraseMsg::MERGE;
+                    }
+                    return EraseMsg::SUCCESS;
+                }
+
+                void dump(std::ostream &o, const size_t n) const {
+                    for (size_t s {0}; s < n; ++s) {
+                        o << "    ";
+                    }
+                    o << "Leaf: [";
+                    if (this->node_size > 0) {
+                        o << this->values[0];
+                        for (size_t i {1}; i < this->node_size; ++i) {
+                            o << ", " << this->values[i];
+                        }
+                    }
+
+                    o << ']' << std::endl;
+                }
+        };
+
+        // number of keys below each child of an internal node; an empty base unless Ranked
+        template<bool enabled, typename = void>
+        struct SubtreeSizes {};
+
+        template<typename Unused>
+        struct SubtreeSizes<true, Unused> {
+                size_type sizes[Node::max_size + 2];
+        };
+
+        struct InternalNode : public Node, public SubtreeSizes<Ranked> {
+                // size of children array +2 so that node can have 1 key too much right before split
+                Node *children[Node::max_size + 2];
+
+                InternalNode(): Node(NodeType::INTERNAL) {}
+
+                // children viewed as what they are; all children of a node have the same type
+                ExternalNode *leaf(const size_type i) const {
+                    return static_cast<ExternalNode *>(children[i]);
+                }
+
+                InternalNode *inner(const size_type i) const {
+                    return static_cast<InternalNode *>(children[i]);
+                }
+
+                // index of the child whose subtree may hold elem
+                template<typename K>
+                size_type find_pos(const K &elem) const {
+                    return this->upper_bound(elem);
+                }
+
+                // keys in the subtree of node, read from the sizes of its top node
+                static size_type keys_below(const Node *node) {
+                    size_type keys {node->is_leaf() ? node->node_size : 0};
+                    if constexpr (Ranked) {
+                        if (!node->is_leaf()) {
+                            const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                            for (size_type i {0}; i <= internal->node_size; ++i) {
+                                keys += internal->sizes[i];
+                            }
+                        }
+                    }
+                    return keys;
+                }
+
+                // sizes from scratch, the children have to be counted already
+                void recount() {
+                    if constexpr (Ranked) {
+                        for (size_type i {0}; i <= this->node_size; ++i) {
+                            this->sizes[i] = keys_below(children[i]);
+                        }
+                    }
+                }
+
+                // recounts the children around pos and then this node, after keys moved between them
+                void recount_around(const size_type pos) {
+                    if constexpr (Ranked) {
+                        const size_type last {std::min(pos + 1, this->node_size)};
+                        for (size_type i {pos > 0 ? pos - 1 : 0}; i <= last; ++i) {
+                            if (!children[i]->is_leaf()) {
+                                inner(i)->recount();
+                            }
+                        }
+                        recount();
+                    }
+                }
+
+                // points the parent link of every child back to this node
+                void adopt_children() {
+                    for (size_type i {0}; i <= this->node_size; ++i) {
+                        children[i]->parent = this;
+                    }
+                }
+
+                // index of child in children, child has to be a child of this node
+                size_type child_pos(const Node *child) const {
+                    size_type pos {0};
+                    while (children[pos] != child) {
+                        ++pos;
+                    }
+                    return pos;
+                }
+
+                // moves leaf/slot into the right sibling if splitting children[pos] carried the slot over
+                void follow_leaf_split(const size_type pos, ExternalNode *&leaf, size_type &slot) const {
+                    if (leaf == this->children[pos] && slot >= leaf->node_size) {
+                        slot -= leaf->node_size;
+                        leaf = leaf->right_neighbour;
+                    }
+                }
+
+                void split(size_type pos, ADS_set &tree) {
+                    ADS_SET_COUNT(tree, splits, 1);
+                    Node *child {this->children[pos]};
+                    Node *right_split {nullptr};
+                    key_type new_key;
+                    if (child->is_leaf()) {
+                        // construct right part
+                        ExternalNode *left_split_e {leaf(pos)};
+                        ExternalNode *right_split_e {tree.create_node<ExternalNode>(left_split_e, left_split_e->right_neighbour)};
+                        size_type e {0};
+                        for (; e <= child->node_size / 2; ++e) {
+                            right_split_e->values[e] = std::move(child->values[e + child->node_size / 2]);
+                        }
+                        right_split_e->node_size = e;
+
+                        // cut left part
+                        child->node_size /= 2;
+
+                        // manage leaf chaining
+                        if (left_split_e->right_neighbour != nullptr) {
+                            left_split_e->right_neighbour->left_neighbour = right_split_e;
+                        }
+                        left_split_e->right_neighbour = right_split_e;
+                        new_key = right_split_e->values[0];
+                        right_split = right_split_e;
+                    } else {
+                        // new key
+                        new_key = std::move(child->values[child->node_size / 2]);
+
+                        // construct right part
+                        InternalNode *left_split_i {inner(pos)};
+                        InternalNode *right_split_i {tree.create_node<InternalNode>()};
+                        size_type i {0};
+                        for (; i < child->node_size / 2; ++i) {
+                            right_split_i->children[i] = left_split_i->children[i + child->node_size / 2 + 1];
+                            right_split_i->values[i] = std::move(child->values[i + child->node_size / 2 + 1]);
+                        }
+                        right_split_i->children[i] = left_split_i->children[i + child->node_size / 2 + 1];
+                        right_split_i->node_size = i;
+                        right_split_i->adopt_children();
+
+                        // cut left part
+                        child->node_size /= 2;
+                        right_split = right_split_i;
+                    }
+
+                    // insert new node
+                    for (size_type j {this->node_size}; j > pos; --j) {
+                        this->values[j] = std::move(this->values[j - 1]);
+                        this->children[j + 1] = this->children[j];
+                    }
+                    this->values[pos] = std::move(new_key);
+                    this->children[pos + 1] = right_split;
+                    right_split->parent = this;
+                    ++this->node_size;
+                    if constexpr (Ranked) {
+                        if (!child->is_leaf()) {
+                            inner(pos)->recount();
+                            inner(pos + 1)->recount();
+                        }
+                        this->recount();
+                    }
+                }
+
+                // fixes the underflow of children[pos]; the tree's right_leaf is moved along if the rightmost leaf gets absorbed
+                void merge(size_type pos, ADS_set &tree) {
+                    MergeDirection direction; // -1 für links, +1 für rechts
+                    if (pos == this->node_size || (pos != 0 && this->children[pos - 1]->node_size < this->children[pos + 1]->node_size)) {
+                        direction = MergeDirection::LEFT;
+                    } else {
+                        direction = MergeDirection::RIGHT;
+                    }
+                    // try and move one key
+                    if (this->children[pos]->is_leaf()) {
+                        if ((pos == 0 || (direction == MergeDirection::LEFT && pos < this->node_size))
+                            && this->children[pos + 1]->node_size > this->min_size) {
+                            this->children[pos]->values[this->children[pos]->node_size] = std::move(this->children[pos + 1]->values[0]);
+                            for (size_type i {0}; i < this->children[pos + 1]->node_size; ++i) {
+                                this->children[pos + 1]->values[i] = std::move(this->children[pos + 1]->values[i + 1]);
+                            }
+                            ++this->children[pos]->node_size;
+                            --this->children[pos + 1]->node_size;
+                            this->values[pos] = this->children[pos + 1]->values[0];
+                            TRACE_IF(this->children[pos]->node_size < this->min_size,
+                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
+                            this->recount_around(pos);
+                            ADS_SET_COUNT(tree, borrows, 1);
+                            return;
+                        }
+                        if ((pos == this->node_size || (direction == MergeDirection::RIGHT && pos > 0))
+                            && this->children[pos - 1]->node_size > this->min_size) {
+                            for (size_type i {this->children[pos]->node_size}; i-- > 0;) {
+                                this->children[pos]->values[i + 1] = std::move(this->children[pos]->values[i]);
+                            }
+                            this->children[pos]->values[0] = std::move(this->children[pos - 1]->values[this->children[pos - 1]->node_size - 1]);
+                            ++this->children[pos]->node_size;
+                            --this->children[pos - 1]->node_size;
+                            this->values[pos - 1] = this->children[pos]->values[0];
+                            TRACE_IF(this->children[pos]->node_size < this->min_size,
+                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
+                            this->recount_around(pos);
+                            ADS_SET_COUNT(tree, borrows, 1);
+                            return;
+                        }
+                    } else {
+                        if ((pos == 0 || (direction == MergeDirection::LEFT && pos < this->node_size))
+                            && this->children[pos + 1]->node_size > this->min_size) {
+                            // move key and child into node at pos (key in parent goes to pos and first key in pos+1 goes in parent
+                            this->children[pos]->values[this->children[pos]->node_size] = std::move(this->values[pos]);
+                            this->values[pos] = std::move(this->children[pos + 1]->values[0]);
+                            inner(pos)->children[this->children[pos]->node_size + 1] = inner(pos + 1)->children[0];
+                            inner(pos + 1)->children[0]->parent = inner(pos);
+                            // restructure node at pos+1; one child ahead because there is 1 more child than keys
+                            inner(pos + 1)->children[0] = inner(pos + 1)->children[1];
+                            for (size_type i {0}; i < this->children[pos + 1]->node_size; ++i) {
+                                this->children[pos + 1]->values[i] = std::move(this->children[pos + 1]->values[i + 1]);
+                                inner(pos + 1)->children[i + 1] = inner(pos + 1)->children[i + 2];
+                            }
+                            // manage node sizes
+                            ++this->children[pos]->node_size;
+                            --this->children[pos + 1]->node_size;
+                            TRACE_IF(this->children[pos]->node_size < this->min_size,
+                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
+                            this->recount_around(pos);
+                            ADS_SET_COUNT(tree, borrows, 1);
+                            return;
+                        }
+                        if ((pos == this->node_size || (direction == MergeDirection::RIGHT && pos > 0))
+                            && this->children[pos - 1]->node_size > this->min_size) {
+                            // restructure node at pos; one child ahead because there is 1 more child than keys
+                            inner(pos)->children[this->children[pos]->node_size + 1] = inner(pos)->children[this->children[pos]->node_size];
+                            for (size_type i {this->children[pos]->node_size}; i-- > 0;) {
+                                this->children[pos]->values[i + 1] = std::move(this->children[pos]->values[i]);
+                                inner(pos)->children[i + 1] = inner(pos)->children[i];
+                            }
+                            // move key and child into node at pos (key in parent goes to pos and last key in pos-1 goes to parent
+                            this->children[pos]->values[0] = std::move(this->values[pos - 1]);
+                            this->values[pos - 1] = std::move(this->children[pos - 1]->values[this->children[pos - 1]->node_size - 1]);
+                            inner(pos)->children[0] = inner(pos - 1)->children[this->children[pos - 1]->node_size];
+                            inner(pos)->children[0]->parent = inner(pos);
+                            // manage node sizes
+                            ++this->children[pos]->node_size;
+                            --this->children[pos - 1]->node_size;
+                            TRACE_IF(this->children[pos]->node_size < this->min_size,
+                                     "SOMETHING WENT WRONG. Key was moved but size is still too low!");
+                            this->recount_around(pos);
+                            ADS_SET_COUNT(tree, borrows, 1);
+                            return;
+                        }
+                    }
+                    ADS_SET_COUNT(tree, merges, 1);
+                    size_t i_left {0};
+                    size_t j_left {pos};
+                    size_t i_right {0};
+                    size_t j_right {pos + 1};
+                    switch (direction) {
+                        case MergeDirection::LEFT:
+                            TRACE_IF(this->children[pos - 1]->node_size + this->children[pos]->node_size > this->max_size + this->min_size,
+                                     "You messed up merged node is too big!");
+                            // move keys and children
+                            if (this->children[pos]->is_leaf()) {
+                                for (; i_left < this->children[pos]->node_size; ++i_left) {
+                                    this->children[pos - 1]->values[i_left + this->children[pos - 1]->node_size] = std::move(this->children[pos]->values[i_left]);
+                                }
+                                // update leaf chaining
+                                leaf(pos - 1)->right_neighbour = leaf(pos)->right_neighbour;
+                                if (leaf(pos)->right_neighbour) {
+                                    leaf(pos)->right_neighbour->left_neighbour = leaf(pos - 1);
+                                }
+                                if (tree.right_leaf == leaf(pos)) {
+                                    tree.right_leaf = leaf(pos - 1);
+                                }
+                                // update size
+                                this->children[pos - 1]->node_size += this->children[pos]->node_size;
+                            } else {
+                                this->children[pos - 1]->values[i_right + this->children[pos - 1]->node_size] = std::move(this->values[pos - 1]);
+                                for (; i_left < this->children[pos]->node_size; ++i_left) {
+                                    this->children[pos - 1]->values[i_left + this->children[pos - 1]->node_size + 1] = std::move(this->children[pos]->values[i_left]);
+                                    inner(pos - 1)->children[i_left + this->children[pos - 1]->node_size + 1] = inner(pos)->children[i_left];
+                                }
+                                inner(pos - 1)->children[i_left + this->children[pos - 1]->node_size + 1] = inner(pos)->children[i_left];
+                                // update size
+                                this->children[pos - 1]->node_size += this->children[pos]->node_size + 1; // +1 because of pulled down value
+                                inner(pos - 1)->adopt_children();
+                            }
+
+                            // delete old stuff
+                            tree.destroy_node(children[pos]);
+
+                            // reorganize parent node
+                            for (; j_left < this->node_size - 1; ++j_left) {
+                                this->values[j_left - 1] = std::move(this->values[j_left]);
+                                children[j_left] = this->children[j_left + 1];
+                            }
+                            this->children[j_left] = this->children[j_left + 1];
+                            --this->node_size;
+                            if (this->children[pos - 1]->node_size > this->max_size) {
+                                TRACE_IF(this->children[pos - 1]->node_size > this->max_size + 1,
+                                         "Split was called in a merg with node_size > 2k+1!");
+                                split(pos - 1, tree);
+                            }
+                            this->recount_around(pos);
+                            break;
+
+                        case MergeDirection::RIGHT:
+                            TRACE_IF(this->children[pos]->node_size + this->children[pos + 1]->node_size > this->max_size + this->min_size,
+                                     "You messed up merged node is too big!");
+                            // move keys and children
+                            if (this->children[pos]->is_leaf()) {
+                                for (; i_right < this->children[pos + 1]->node_size; ++i_right) {
+                                    this->children[pos]->values[i_right + this->children[pos]->node_size] = std::move(this->children[pos + 1]->values[i_right]);
+                                }
+                                // update leaf chaining
+                                leaf(pos)->right_neighbour = leaf(pos + 1)->right_neighbour;
+                                if (leaf(pos + 1)->right_neighbour) {
+                                    leaf(pos + 1)->right_neighbour->left_neighbour = leaf(pos);
+                                }
+                                if (tree.right_leaf == leaf(pos + 1)) {
+                                    tree.right_leaf = leaf(pos);
+                                }
+                                // update size
+                                this->children[pos]->node_size += this->children[pos + 1]->node_size;
+                            } else {
+                                /* this statement is because when an internal node is merged the key in parent which
+                                  will be discarded needs to be pulled down into the merged node */
+                                this->children[pos]->values[i_right + this->children[pos]->node_size] = std::move(this->values[pos]);
+                                // move rest of the stuff
+                                for (; i_right < this->children[pos + 1]->node_size; ++i_right) {
+                                    this->children[pos]->values[i_right + this->children[pos]->node_size + 1] = std::move(this->children[pos + 1]->values[i_right]);
+                                    inner(pos)->children[i_right + this->children[pos]->node_size + 1] = inner(pos + 1)->children[i_right];
+                                }
+                                // move last child as well
+                                inner(pos)->children[i_right + this->children[pos]->node_size + 1] = inner(pos + 1)->children[i_right];
+                                // update size
+                                this->children[pos]->node_size += this->children[pos + 1]->node_size + 1; // +1 because of pulled down value
+                                inner(pos)->adopt_children();
+                            }
+
+                            // delete old stuff
+                            tree.destroy_node(children[pos + 1]);
+                            // reorganize parent node
+                            for (; j_right < this->node_size; ++j_right) {
+                                this->values[j_right - 1] = std::move(this->values[j_right]);
+                                this->children[j_right] = this->children[j_right + 1];
+                            }
+                            this->children[j_right] = this->children[j_right + 1];
+                            --this->node_size;
+                            if (this->children[pos]->node_size > this->max_size) {
+                                TRACE_IF(this->children[pos]->node_size > this->max_size + 1, "Split was called in a merg with node_size > 2k+1!");
+                                split(pos, tree);
+                            }
+                            this->recount_around(pos);
+                    }
+                }
+
+                // evens out children[pos] and children[pos + 1], or fuses them if they fit into one node; both may be far below min_size
+                void rebalance(const size_type pos, ADS_set &tree) {
+                    Node *left {this->children[pos]};
+                    Node *right {this->children[pos + 1]};
+                    if (left->is_leaf()) {
+                        ExternalNode *left_e {leaf(pos)};
+                        ExternalNode *right_e {leaf(pos + 1)};
+                        const size_type total {left->node_size + right->node_size};
+                        if (total <= this->max_size) {
+                            std::move(right->values, right->values + right->node_size, left->values + left->node_size);
+                            left->node_size = total;
+                            left_e->right_neighbour = right_e->right_neighbour;
+                            if (right_e->right_neighbour != nullptr) {
+                                right_e->right_neighbour->left_neighbour = left_e;
+                            }
+                            remove_child(pos + 1, tree);
+                            this->recount_around(pos);
+                            ADS_SET_COUNT(tree, merges, 1);
+                            return;
+                        }
+                        const size_type keep {total / 2};
+                        if (left->node_size > keep) {
+                            const size_type moved {left->node_size - keep};
+                            std::move_backward(right->values, right->values + right->node_size, right->values + right->node_size + moved);
+                            std::move(left->values + keep, left->values + left->node_size, right->values);
+                        } else {
+                            const size_type moved {keep - left->node_size};
+                            std::move(right->values, right->values + moved, left->values + left->node_size);
+                            std::move(right->values + moved, right->values + right->node_size, right->values);
+                        }
+                        right->node_size = total - keep;
+                        left->node_size = keep;
+                        this->values[pos] = right->values[0];
+                        this->recount_around(pos);
+                        ADS_SET_COUNT(tree, borrows, 1);
+                        return;
+                    }
+                    InternalNode *left_i {inner(pos)};
+                    InternalNode *right_i {inner(pos + 1)};
+                    // the separator is pulled down, so both nodes together hold one key more
+                    const size_type total {left->node_size + right->node_size + 1};
+                    if (total <= this->max_size) {
+                        left->values[left->node_size] = std::move(this->values[pos]);
+                        std::move(right->values, right->values + right->node_size, left->values + left->node_size + 1);
+                        std::copy(right_i->children, right_i->children + right->node_size + 1, left_i->children + left->node_size + 1);
+                        left->node_size = total;
+                        left_i->adopt_children();
+                        remove_child(pos + 1, tree);
+                        this->recount_around(pos);
+                        ADS_SET_COUNT(tree, merges, 1);
+                        return;
+                    }
+                    // one key of the concatenation goes up again
+                    const size_type keep {(total - 1) / 2};
+                    if (left->node_size > keep) {
+                        const size_type moved {left->node_size - keep};
+                        std::move_backward(right->values, right->values + right->node_size, right->values + right->node_size + moved);
+                        std::copy_backward(right_i->children, right_i->children + right->node_size + 1, right_i->children + right->node_size + 1 + moved);
+                        right->values[moved - 1] = std::move(this->values[pos]);
+                        std::move(left->values + keep + 1, left->values + left->node_size, right->values);
+                        std::copy(left_i->children + keep + 1, left_i->children + left->node_size + 1, right_i->children);
+                        this->values[pos] = std::move(left->values[keep]);
+                    } else if (left->node_size < keep) {
+                        const size_type moved {keep - left->node_size};
+                        left->values[left->node_size] = std::move(this->values[pos]);
+                        std::move(right->values, right->values + moved - 1, left->values + left->node_size + 1);
+                        std::copy(right_i->children, right_i->children + moved, left_i->children + left->node_size + 1);
+                        this->values[pos] = std::move(right->values[moved - 1]);
+                        std::move(right->values + moved, right->values + right->node_size, right->values);
+                        std::copy(right_i->children + moved, right_i->children + right->node_size + 1, right_i->children);
+                    }
+                    right->node_size = total - 1 - keep;
+                    left->node_size = keep;
+                    left_i->adopt_children();
+                    right_i->adopt_children();
+                    this->recount_around(pos);
+                    ADS_SET_COUNT(tree, borrows, 1);
+                }
+
+                // drops children[pos] (pos > 0) together with the separator in front of it and frees the node
+                void remove_child(const size_type pos, ADS_set &tree) {
+                    tree.destroy_node(this->children[pos]);
+                    std::move(this->values + pos, this->values + this->node_size, this->values + pos - 1);
+                    std::copy(this->children + pos + 1, this->children + this->node_size + 1, this->children + pos);
+                    --this->node_size;
+                }
+
+                void dump(std::ostream &o, const size_t n) const {
+                    for (size_t s {0}; s < n; ++s) {
+                        o << "    ";
+                    }
+                    o << "Internal[";
+                    if (this->node_size > 0) {
+                        o << this->values[0];
+                        for (size_t i {1}; i < this->node_size; ++i) {
+                            o << ", " << this->values[i];
+                        }
+                    }
+
+                    o << "]" << std::endl;
+                    for (size_t i {0}; i < this->node_size + 1; ++i) {
+                        Node::dump(this->children[i], o, n + 1);
+                    }
+                }
+        };
+
+        using alloc_traits = std::allocator_traits<Allocator>;
+        template<typename T>
+        using node_allocator = typename alloc_traits::template rebind_alloc<T>;
+        template<typename T>
+        using node_traits = typename alloc_traits::template rebind_traits<T>;
+
+        // allocators offering exclusive()/release() (like ADS_pool_allocator) can drop all nodes in one go
+        template<typename A, typename = void>
+        struct releases_in_bulk : std::false_type {};
+        template<typename A>
+        struct releases_in_bulk<A, std::void_t<decltype(std::declval<const A &>().exclusive()), decltype(std::declval<A &>().release())>>
+            : std::true_type {};
+
+        // keys pack() can store as prefix and suffix bytes
+        template<typename T>
+        struct is_basic_string : std::false_type {};
+        template<typename CharT, typename Traits, typename A>
+        struct is_basic_string<std::basic_string<CharT, Traits, A>> : std::true_type {};
+
+        Allocator alloc;
+        size_type sz;
+        Node *root;
+        ExternalNode *left_leaf;
+        ExternalNode *right_leaf;
+        // set once a snapshot was taken; until the tree is rebuilt any node may then be shared
+        bool shared;
+        // see set_relaxed()
+        bool relaxed_erase;
+        // keys taken by insert_buffered() and not yet in the tree, possibly in it already: the latest few go into incoming,
+        // which is merged into pending when it is full. both are ascending and free of duplicates
+        std::vector<key_type> pending;
+        std::vector<key_type> incoming;
+#if ADS_SET_STATS
+        // updated from const lookups too, possibly by several readers at once; copies and moves start from zero
+        struct Counters {
+                std::atomic<size_type> splits {0};
+                std::atomic<size_type> merges {0};
+                std::atomic<size_type> borrows {0};
+                std::atomic<size_type> lookups {0};
+                std::atomic<size_type> comparisons {0};
+                // only read by lookups, so readers that do not count share the cache line instead of writing to it
+                bool counting {true};
+        };
+        mutable Counters counters;
+#endif
+
+        template<typename T, typename... Args>
+        T *create_node(Args &&...args) {
+            node_allocator<T> node_alloc {alloc};
+            T *node {node_traits<T>::allocate(node_alloc, 1)};
+            try {
+                node_traits<T>::construct(node_alloc, node, std::forward<Args>(args)...);
+            } catch (...) {
+                node_traits<T>::deallocate(node_alloc, node, 1);
+                throw;
+            }
+            return node;
+        }
+
+        template<typename T>
+        void destroy_node(T *node) {
+            node_allocator<T> node_alloc {alloc};
+            node_traits<T>::destroy(node_alloc, node);
+            node_traits<T>::deallocate(node_alloc, node, 1);
+        }
+
+        // frees a single node as what it actually is, its children are left alone
+        void destroy_node(Node *node) {
+            if (node->is_leaf()) {
+                destroy_node(static_cast<ExternalNode *>(node));
+            } else {
+                destroy_node(static_cast<InternalNode *>(node));
+            }
+        }
+
+        // frees node, which nothing links to any more, and all nodes below it that are not shared, with neither
+        // recursion nor memory: a node is left as soon as its last remaining child is, and its node_size counts down to
+        // the next one. shared children only lose a reference in O(1), unless it was their last. leaves are kept if
+        // with_leaves is false
+        void free_nodes(Node *node, const bool with_leaves = true) {
+            InternalNode *parent {nullptr};
+            for (;;) {
+                if (node->is_leaf()) {
+                    if (with_leaves) {
+                        destroy_node(node);
+                    }
+                } else {
+                    // the parent links of nodes that were shared may be stale, they are set again on the way down
+                    InternalNode *internal {static_cast<InternalNode *>(node)};
+                    internal->parent = parent;
+                    parent = internal;
+                }
+                // on to the last child of parent that is still there; parents without any are freed
+                node = nullptr;
+                while (node == nullptr) {
+                    if (parent == nullptr) {
+                        return;
+                    }
+                    Node *child {parent->children[parent->node_size]};
+                    if (child == nullptr) {
+                        InternalNode *above {parent->parent};
+                        destroy_node(parent);
+                        parent = above;
+                        continue;
+                    }
+                    parent->children[parent->node_size] = nullptr;
+                    if (parent->node_size > 0) {
+                        // the sibling is up next, its cache miss overlaps with freeing this subtree
+                        --parent->node_size;
+                        prefetch_node(parent->children[parent->node_size]);
+                    }
+                    if (child->refs.load(std::memory_order_acquire) == 1 || child->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        node = child;
+                    }
+                }
+            }
+        }
+
+        // drops one reference to node; the last one frees it and drops the references it holds to its children
+        void release(Node *node) {
+            if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                free_nodes(node);
+            }
+        }
+
+        static size_type count_keys(const Node *node) {
+            if (node->is_leaf() || Ranked) {
+                return InternalNode::keys_below(node);
+            }
+            const InternalNode *internal {static_cast<const InternalNode *>(node)};
+            size_type keys {0};
+            for (size_type i {0}; i <= internal->node_size; ++i) {
+                keys += count_keys(internal->children[i]);
+            }
+            return keys;
+        }
+
+        // frees the subtree, a subtree that is shared with a snapshot only loses this reference
+        void destroy_subtree(Node *node) {
+            if (node != nullptr && (node->refs.load(std::memory_order_acquire) == 1 || node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)) {
+                free_nodes(node);
+            }
+        }
+
+        // frees the internal nodes above the leaves, the leaves themselves are kept; none of them may be shared
+        void destroy_internal_nodes(Node *node) {
+            free_nodes(node, false);
+        }
+
+        // frees the whole tree; a pool owned by this set alone is dropped chunk by chunk instead of node by node
+        void destroy_tree() {
+            if constexpr (releases_in_bulk<Allocator>::value && std::is_trivially_destructible_v<key_type>) {
+                if (root != nullptr && alloc.exclusive()) {
+                    alloc.release();
+                    return;
+                }
+            }
+            destroy_subtree(root);
+        }
+
+        // deep copy of the subtree; last_leaf is the leaf cloned most recently and gets chained to new leaves
+        Node *clone_subtree(const Node *node, ExternalNode *&last_leaf) {
+            if (node->is_leaf()) {
+                ExternalNode *copy {create_node<ExternalNode>(last_leaf, nullptr)};
+                std::copy(node->values, node->values + node->node_size, copy->values);
+                copy->node_size = node->node_size;
+                if (last_leaf != nullptr) {
+                    last_leaf->right_neighbour = copy;
+                }
+                last_leaf = copy;
+                return copy;
+            }
+            const InternalNode *internal {static_cast<const InternalNode *>(node)};
+            InternalNode *copy {create_node<InternalNode>()};
+            std::copy(internal->values, internal->values + internal->node_size, copy->values);
+            for (size_type i {0}; i <= internal->node_size; ++i) {
+                copy->children[i] = clone_subtree(internal->children[i], last_leaf);
+            }
+            copy->node_size = internal->node_size;
+            copy->adopt_children();
+            if constexpr (Ranked) {
+                std::copy(internal->sizes, internal->sizes + internal->node_size + 1, copy->sizes);
+            }
+            return copy;
+        }
+
+        // a node that a snapshot refers to as well is never written to. own() swaps it for a private copy in the slot
+        // pointing to it (root, children[i] of an owned parent or a detached subtree). parent links and leaf neighbours
+        // always describe the live tree, snapshots do not read them, so they are updated on shared nodes too
+        void own(Node *&slot) {
+            if (!shared || slot->refs.load(std::memory_order_acquire) == 1) {
+                return;
+            }
+            Node *node {slot};
+            Node *copy {nullptr};
+            if (node->is_leaf()) {
+                ExternalNode *original {static_cast<ExternalNode *>(node)};
+                ExternalNode *leaf {create_node<ExternalNode>(original->left_neighbour, original->right_neighbour)};
+                std::copy(original->values, original->values + original->node_size, leaf->values);
+                leaf->node_size = original->node_size;
+                if (leaf->left_neighbour != nullptr) {
+                    leaf->left_neighbour->right_neighbour = leaf;
+                }
+                if (leaf->right_neighbour != nullptr) {
+                    leaf->right_neighbour->left_neighbour = leaf;
+                }
+                if (left_leaf == original) {
+                    left_leaf = leaf;
+                }
+                if (right_leaf == original) {
+                    right_leaf = leaf;
+                }
+                copy = leaf;
+            } else {
+                const InternalNode *original {static_cast<const InternalNode *>(node)};
+                InternalNode *internal {create_node<InternalNode>()};
+                std::copy(original->values, original->values + original->node_size, internal->values);
+                std::copy(original->children, original->children + original->node_size + 1, internal->children);
+                if constexpr (Ranked) {
+                    std::copy(original->sizes, original->sizes + original->node_size + 1, internal->sizes);
+                }
+                internal->node_size = original->node_size;
+                for (size_type i {0}; i <= internal->node_size; ++i) {
+                    internal->children[i]->refs.fetch_add(1, std::memory_order_relaxed);
+                }
+                internal->adopt_children();
+                copy = internal;
+            }
+            copy->parent = node->parent;
+            slot = copy;
+            release(node);
+        }
+
+        // like find_leaf below top, but every node on the way is owned afterwards
+        ExternalNode *own_path(Node *&top, const key_type &key) {
+            Node **slot {&top};
+            own(*slot);
+            while (!(*slot)->is_leaf()) {
+                InternalNode *internal {static_cast<InternalNode *>(*slot)};
+                slot = &internal->children[internal->find_pos(key)];
+                own(*slot);
+            }
+            return static_cast<ExternalNode *>(*slot);
+        }
+
+        // iterator to slot of leaf; the slot past the last key continues in the next leaf
+        Iterator leaf_iterator(const ExternalNode *leaf, const size_type slot) const {
+            if (slot < leaf->node_size) {
+                return Iterator(this, leaf, slot);
+            }
+            if (leaf->right_neighbour == nullptr) {
+                return Iterator(this);
+            }
+            return Iterator(this, leaf->right_neighbour, 0);
+        }
+
+        // iterative descent to the only leaf that may hold key; root must exist
+        template<typename K>
+        ExternalNode *find_leaf(const K &key) const {
+            Node *node {root};
+            ADS_SET_COUNT(*this, lookups, 1);
+            while (!node->is_leaf()) {
+                const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                ADS_SET_COUNT(*this, comparisons, search_cost(internal->node_size));
+                node = internal->children[internal->find_pos(key)];
+            }
+            ADS_SET_COUNT(*this, comparisons, search_cost(node->node_size));
+            return static_cast<ExternalNode *>(node);
+        }
+
+        // comparisons a binary search over n keys makes, ceil(log2(n + 1))
+        static constexpr size_type search_cost(size_type n) {
+            size_type steps {0};
+            for (; n > 0; n /= 2) {
+                ++steps;
+            }
+            return steps;
+        }
+
+        // adds delta to the sizes on the path from node up to the root
+        void count_upwards(Node *node, const difference_type delta) {
+            if constexpr (Ranked) {
+                for (InternalNode *parent {node->parent}; parent != nullptr; node = parent, parent = parent->parent) {
+                    parent->sizes[parent->child_pos(node)] += static_cast<size_type>(delta);
+                }
+            }
+        }
+
+        // splits the overflowing leaf and every ancestor that overflows in turn; leaf/slot follow the split key
+        void split_upwards(ExternalNode *&leaf, size_type &slot) {
+            Node *child {leaf};
+            while (child->node_size > Node::max_size) {
+                InternalNode *parent {child->parent};
+                if (parent == nullptr) {
+                    parent = create_node<InternalNode>();
+                    parent->children[0] = child;
+                    child->parent = parent;
+                    root = parent;
+                }
+                const size_type pos {parent->child_pos(child)};
+                parent->split(pos, *this);
+                parent->follow_leaf_split(pos, leaf, slot);
+                child = parent;
+            }
+            if (right_leaf->right_neighbour != nullptr) {
+                right_leaf = right_leaf->right_neighbour;
+            }
+        }
+
+        // merges the underflowing leaf and every ancestor that underflows in turn, then shrinks an empty root
+        void merge_upwards(Node *child) {
+            while (child->parent != nullptr && child->node_size < Node::min_size) {
+                InternalNode *parent {child->parent};
+                const size_type pos {parent->child_pos(child)};
+                // the siblings give or take keys
+                if (pos > 0) {
+                    own(parent->children[pos - 1]);
+                }
+                if (pos < parent->node_size) {
+                    own(parent->children[pos + 1]);
+                }
+                parent->merge(pos, *this);
+                child = parent;
+            }
+            if (!root->is_leaf() && root->node_size == 0) {
+                InternalNode *old_root {static_cast<InternalNode *>(root)};
+                root = old_root->children[0];
+                root->parent = nullptr;
+                destroy_node(old_root);
+            }
+        }
+
+        // evens the underfull leaf out with a sibling or fuses the two, internal nodes that underflow in turn are merged as
+        // usual; the returned leaf is the left one of the pair. the path to the leaf has to be owned
+        ExternalNode *rebalance_leaf(ExternalNode *leaf) {
+            InternalNode *parent {leaf->parent};
+            size_type pos {parent->child_pos(leaf)};
+            if (pos == parent->node_size) {
+                --pos;
+            }
+            own(parent->children[pos]);
+            own(parent->children[pos + 1]);
+            ExternalNode *left {parent->leaf(pos)};
+            const bool right_edge {parent->children[pos + 1] == right_leaf};
+            parent->rebalance(pos, *this);
+            // a fused rightmost pair leaves left without a right neighbour
+            if (right_edge && left->right_neighbour == nullptr) {
+                right_leaf = left;
+            }
+            if (parent->node_size < Node::min_size) {
+                merge_upwards(parent);
+            }
+            return left;
+        }
+
+        // an erase took leaf below min_size; relaxed sets only get rid of empty leaves
+        void leaf_underflow(ExternalNode *leaf) {
+            if (!relaxed_erase) {
+                merge_upwards(leaf);
+            } else if (leaf->node_size == 0 && leaf->parent != nullptr) {
+                rebalance_leaf(leaf);
+            }
+        }
+
+        // a tree detached from the set while it is cut or grafted; height 0 is a single leaf and nullptr stands for no keys.
+        // only the top node may be below min_size
+        struct Subtree {
+                Node *node;
+                size_type height;
+        };
+
+        Subtree whole_tree() const {
+            size_type height {0};
+            for (const Node *node {root}; node != nullptr && !node->is_leaf(); node = static_cast<const InternalNode *>(node)->children[0]) {
+                ++height;
+            }
+            return Subtree {root, height};
+        }
+
+        static ExternalNode *edge_leaf(Node *node, const bool rightmost) {
+            while (!node->is_leaf()) {
+                node = static_cast<InternalNode *>(node)->children[rightmost ? node->node_size : 0];
+            }
+            return static_cast<ExternalNode *>(node);
+        }
+
+        // makes tree the tree of the set; sz is up to the caller
+        void adopt_tree(const Subtree tree) {
+            root = tree.node;
+            left_leaf = root == nullptr ? nullptr : edge_leaf(root, false);
+            right_leaf = root == nullptr ? nullptr : edge_leaf(root, true);
+        }
+
+        // splits node and every ancestor that overflows in turn; returns the top of the tree, which may be a new node
+        Node *split_ancestors(Node *node) {
+            while (node->node_size > Node::max_size) {
+                InternalNode *parent {node->parent};
+                if (parent == nullptr) {
+                    parent = create_node<InternalNode>();
+                    parent->children[0] = node;
+                    node->parent = parent;
+                }
+                parent->split(parent->child_pos(node), *this);
+                node = parent;
+            }
+            while (node->parent != nullptr) {
+                node = node->parent;
+            }
+            return node;
+        }
+
+        // hangs the lower tree into the spine of the higher one; all keys of left are less than separator, which is not
+        // greater than any key of right. costs one step per level the heights differ
+        Subtree join_subtrees(Subtree left, const key_type &separator, Subtree right) {
+            if (left.node == nullptr) {
+                return right;
+            }
+            if (right.node == nullptr) {
+                return left;
+            }
+            // the nodes on the spine and the siblings a graft is rebalanced with get written to
+            own(left.node);
+            own(right.node);
+            if (left.height == right.height) {
+                InternalNode *top {create_node<InternalNode>()};
+                top->children[0] = left.node;
+                top->children[1] = right.node;
+                top->values[0] = separator;
+                top->node_size = 1;
+                top->adopt_children();
+                top->recount();
+                if (left.node->node_size < Node::min_size || right.node->node_size < Node::min_size) {
+                    top->rebalance(0, *this);
+                }
+                if (top->node_size == 0) {
+                    Node *node {top->children[0]};
+                    node->parent = nullptr;
+                    destroy_node(top);
+                    return Subtree {node, left.height};
+                }
+                return Subtree {top, left.height + 1};
+            }
+            if (left.height > right.height) {
+                InternalNode *node {static_cast<InternalNode *>(left.node)};
+                for (size_type h {left.height}; h > right.height + 1; --h) {
+                    own(node->children[node->node_size]);
+                    node = node->inner(node->node_size);
+                }
+                const size_type grafted {InternalNode::keys_below(right.node)};
+                node->values[node->node_size] = separator;
+                node->children[++node->node_size] = right.node;
+                right.node->parent = node;
+                node->recount();
+                if (right.node->node_size < Node::min_size) {
+                    own(node->children[node->node_size - 1]);
+                    node->rebalance(node->node_size - 1, *this);
+                }
+                count_upwards(node, static_cast<difference_type>(grafted));
+                Node *top {split_ancestors(node)};
+                return Subtree {top, left.height + (top != left.node ? 1 : 0)};
+            }
+            InternalNode *node {static_cast<InternalNode *>(right.node)};
+            for (size_type h {right.height}; h > left.height + 1; --h) {
+                own(node->children[0]);
+                node = node->inner(0);
+            }
+            std::move_backward(node->values, node->values + node->node_size, node->values + node->node_size + 1);
+            std::copy_backward(node->children, node->children + node->node_size + 1, node->children + node->node_size + 2);
+            const size_type grafted {InternalNode::keys_below(left.node)};
+            node->values[0] = separator;
+            node->children[0] = left.node;
+            left.node->parent = node;
+            ++node->node_size;
+            node->recount();
+            if (left.node->node_size < Node::min_size) {
+                own(node->children[1]);
+                node->rebalance(0, *this);
+            }
+            count_upwards(node, static_cast<difference_type>(grafted));
+            Node *top {split_ancestors(node)};
+            return Subtree {top, right.height + (top != right.node ? 1 : 0)};
+        }
+
+        // cuts tree into the keys less than key and the others along the path to key; the pieces left and right of the
+        // path are joined back level by level, so the heights telescope to O(log n). the leaf chain is cut as well
+        std::pair<Subtree, Subtree> split_subtree(const Subtree tree, const key_type &key) {
+            if (tree.height == 0) {
+                ExternalNode *leaf {static_cast<ExternalNode *>(tree.node)};
+                const size_type cut {leaf->lower_bound(key)};
+                if (cut == 0) {
+                    if (leaf->left_neighbour != nullptr) {
+                        leaf->left_neighbour->right_neighbour = nullptr;
+                        leaf->left_neighbour = nullptr;
+                    }
+                    return {Subtree {nullptr, 0}, tree};
+                }
+                Subtree rest {nullptr, 0};
+                if (cut < leaf->node_size) {
+                    ExternalNode *right {create_node<ExternalNode>(nullptr, leaf->right_neighbour)};
+                    if (leaf->right_neighbour != nullptr) {
+                        leaf->right_neighbour->left_neighbour = right;
+                    }
+                    std::move(leaf->values + cut, leaf->values + leaf->node_size, right->values);
+                    right->node_size = leaf->node_size - cut;
+                    leaf->node_size = cut;
+                    rest.node = right;
+                } else if (leaf->right_neighbour != nullptr) {
+                    leaf->right_neighbour->left_neighbour = nullptr;
+                }
+                leaf->right_neighbour = nullptr;
+                return {tree, rest};
+            }
+
+            InternalNode *node {static_cast<InternalNode *>(tree.node)};
+            const size_type pos {node->find_pos(key)};
+            const size_type height {tree.height - 1};
+            Node *child {node->children[pos]};
+            child->parent = nullptr;
+
+            // children behind the path move into a new node, the ones in front of it stay in node
+            Subtree right {nullptr, height};
+            key_type right_separator {};
+            if (pos < node->node_size) {
+                right_separator = node->values[pos];
+                if (pos + 1 == node->node_size) {
+                    right.node = node->children[pos + 1];
+                    right.node->parent = nullptr;
+                } else {
+                    InternalNode *piece {create_node<InternalNode>()};
+                    std::move(node->values + pos + 1, node->values + node->node_size, piece->values);
+                    std::copy(node->children + pos + 1, node->children + node->node_size + 1, piece->children);
+                    piece->node_size = node->node_size - pos - 1;
+                    piece->adopt_children();
+                    if constexpr (Ranked) {
+                        std::copy(node->sizes + pos + 1, node->sizes + node->node_size + 1, piece->sizes);
+                    }
+                    right = Subtree {piece, tree.height};
+                }
+            }
+            Subtree left {nullptr, height};
+            key_type left_separator {};
+            if (pos == 0) {
+                destroy_node(node);
+            } else {
+                left_separator = node->values[pos - 1];
+                if (pos == 1) {
+                    left.node = node->children[0];
+                    left.node->parent = nullptr;
+                    destroy_node(node);
+                } else {
+                    node->node_size = pos - 1;
+                    left = Subtree {node, tree.height};
+                }
+            }
+
+            auto [child_left, child_right] {split_subtree(Subtree {child, height}, key)};
+            return {join_subtrees(left, left_separator, child_left), join_subtrees(child_right, right_separator, right)};
+        }
+
+        // number of nodes a level of n entries is cut into when every node should hold about fill entries
+        static size_type level_width(const size_type n, const size_type fill, const size_type min) {
+            size_type width {(n + fill - 1) / fill};
+            if (width > 1 && n / width < min) {
+                width = n / min;
+            }
+            return width;
+        }
+
+        template<typename InputIt>
+        static bool is_strictly_ascending(InputIt first, InputIt last) {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+                return std::adjacent_find(first, last, [](const key_type &lhs, const key_type &rhs) { return !key_compare {}(lhs, rhs); })
+                       == last;
+            } else {
+                return false;
+            }
+        }
+
+        // stacks internal levels on top of the chained leaves (each paired with its smallest key) until a single root is left
+        void build_levels(std::vector<std::pair<Node *, key_type>> level) {
+            while (level.size() > 1) {
+                const size_type nodes {level_width(level.size(), Node::max_size + 1, Node::min_size + 1)};
+                std::vector<std::pair<Node *, key_type>> parents;
+                parents.reserve(nodes);
+                size_type child {0};
+                for (size_type p {0}; p < nodes; ++p) {
+                    const size_type fanout {level.size() / nodes + (p < level.size() % nodes ? 1 : 0)};
+                    InternalNode *parent {create_node<InternalNode>()};
+                    parent->children[0] = level[child].first;
+                    for (size_type c {1}; c < fanout; ++c) {
+                        parent->values[c - 1] = std::move(level[child + c].second);
+                        parent->children[c] = level[child + c].first;
+                    }
+                    parent->node_size = fanout - 1;
+                    parent->adopt_children();
+                    parent->recount();
+                    parents.emplace_back(parent, std::move(level[child].second));
+                    child += fanout;
+                }
+                level = std::move(parents);
+            }
+            root = level[0].first;
+            root->parent = nullptr;
+        }
+
+        // turns the chain from left_leaf up to last into a tree; last may be underfull and is fused with or evened out
+        // against its left neighbour, every other leaf has to hold at least min_size keys
+        void build_from_leaves(ExternalNode *last) {
+            if (ExternalNode *left {last->left_neighbour}; left != nullptr && last->node_size < Node::min_size) {
+                if (left->node_size + last->node_size <= Node::max_size) {
+                    std::move(last->values, last->values + last->node_size, left->values + left->node_size);
+                    left->node_size += last->node_size;
+                    left->right_neighbour = nullptr;
+                    destroy_node(last);
+                    last = left;
+                } else {
+                    const size_type moved {(left->node_size - last->node_size) / 2};
+                    std::move_backward(last->values, last->values + last->node_size, last->values + last->node_size + moved);
+                    std::move(left->values + left->node_size - moved, left->values + left->node_size, last->values);
+                    left->node_size -= moved;
+                    last->node_size += moved;
+                }
+            }
+            std::vector<std::pair<Node *, key_type>> level;
+            for (ExternalNode *leaf {left_leaf}; leaf != nullptr; leaf = leaf->right_neighbour) {
+                level.emplace_back(leaf, leaf->values[0]);
+            }
+            build_levels(std::move(level));
+            right_leaf = last;
+        }
+
+        // builds the tree bottom up from a strictly ascending range; the set has to be empty
+        template<typename InputIt>
+        void bulk_load(InputIt first, InputIt last, size_type leaf_fill) {
+            if constexpr (!std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+                std::vector<key_type> buffer(first, last);
+                bulk_load(buffer.begin(), buffer.end(), leaf_fill);
+            } else {
+                TRACE_IF(sz != 0, "bulk_load was called on a set that is not empty!");
+                const size_type n {static_cast<size_type>(std::distance(first, last))};
+                if (n == 0) {
+                    return;
+                }
+                leaf_fill = std::clamp(leaf_fill, Node::min_size, Node::max_size);
+                // the empty root left by erasing may still belong to a snapshot, then the keys go into a leaf of their own
+                if (root != nullptr && (shared || root->refs.load(std::memory_order_acquire) > 1)) {
+                    release(root);
+                    root = left_leaf = right_leaf = nullptr;
+                }
+                if (root == nullptr) {
+                    root = left_leaf = right_leaf = create_node<ExternalNode>();
+                }
+
+                // fill leaves left to right; the empty root becomes the first leaf
+                std::vector<std::pair<Node *, key_type>> level;
+                const size_type leaves {level_width(n, leaf_fill, Node::min_size)};
+                level.reserve(leaves);
+                ExternalNode *leaf {left_leaf};
+                for (size_type l {0}; l < leaves; ++l) {
+                    if (l > 0) {
+                        leaf->right_neighbour = create_node<ExternalNode>(leaf, nullptr);
+                        leaf = leaf->right_neighbour;
+                    }
+                    const size_type leaf_size {n / leaves + (l < n % leaves ? 1 : 0)};
+                    for (; leaf->node_size < leaf_size; ++first) {
+                        leaf->values[leaf->node_size++] = *first;
+                    }
+                    level.emplace_back(leaf, leaf->values[0]);
+                }
+
+                build_levels(std::move(level));
+                right_leaf = leaf;
+                sz = n;
+            }
+        }
+
+        // layout of a saved image, see save(); offsets are in bytes from the start of the file
+        struct ImageHeader {
+                char magic[8];
+                std::uint32_t version;
+                std::uint32_t byte_order;
+                std::uint32_t key_size;
+                std::uint32_t key_align;
+                std::uint64_t size;
+                std::uint64_t keys_offset;
+                std::uint64_t index_offset;
+                std::uint64_t index_stride;
+                std::uint64_t index_entries;
+        };
+        static constexpr char image_magic[8] {'A', 'D', 'S', '_', 'S', 'E', 'T', '\0'};
+        static constexpr std::uint32_t image_version {1};
+        static constexpr std::uint32_t image_byte_order {0x01020304};
+        static constexpr size_type image_page {4096};
+
+        // fewest keys a parallel load hands to one worker, smaller inputs use fewer threads
+        static constexpr size_type parallel_grain {size_type {1} << 14};
+
+        // calls work(0) to work(workers - 1) side by side, the calling thread takes 0; if a thread cannot be started its
+        // share runs inline. the first exception of a worker is rethrown once all of them are done
+        template<typename Work>
+        static void run_parallel(const size_type workers, const Work &work) {
+            std::vector<std::exception_ptr> errors(workers);
+            const auto guarded {[&work, &errors](const size_type w) {
+                try {
+                    work(w);
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            }};
+            std::vector<std::thread> threads;
+            threads.reserve(workers);
+            for (size_type w {1}; w < workers; ++w) {
+                try {
+                    threads.emplace_back(guarded, w);
+                } catch (const std::system_error &) {
+                    guarded(w);
+                }
+            }
+            guarded(0);
+            for (auto &thread: threads) {
+                thread.join();
+            }
+            for (const auto &error: errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        // sorts and deduplicates keys with up to threads workers and loads them into the empty set. every worker owns a
+        // contiguous chunk: chunks are sorted on their own and merged pairwise, then the leaves are allocated as one
+        // chain and each worker moves its distinct keys into their final slots, which may start halfway into a leaf
+        void parallel_load(std::vector<key_type> &keys, const unsigned threads) {
+            TRACE_IF(sz != 0, "parallel_load was called on a set that is not empty!");
+            const size_type total {keys.size()};
+            const size_type workers {std::clamp<size_type>(total / parallel_grain, 1, std::max(threads, 1u))};
+            const auto equivalent {[](const key_type &lhs, const key_type &rhs) { return !key_compare {}(lhs, rhs); }};
+            if (workers == 1) {
+                std::sort(keys.begin(), keys.end(), key_compare {});
+                keys.erase(std::unique(keys.begin(), keys.end(), equivalent), keys.end());
+                bulk_load(keys.begin(), keys.end(), Node::max_size);
+                return;
+            }
+
+            std::vector<size_type> bounds(workers + 1);
+            for (size_type w {0}; w <= workers; ++w) {
+                bounds[w] = total / workers * w + total % workers * w / workers;
+            }
+            run_parallel(workers, [&keys, &bounds](const size_type w) {
+                std::sort(keys.begin() + bounds[w], keys.begin() + bounds[w + 1], key_compare {});
+            });
+            for (size_type width {1}; width < workers; width *= 2) {
+                run_parallel((workers - width + 2 * width - 1) / (2 * width), [&keys, &bounds, width, workers](const size_type pair) {
+                    const size_type w {2 * width * pair};
+                    std::inplace_merge(keys.begin() + bounds[w], keys.begin() + bounds[w + width],
+                                       keys.begin() + bounds[std::min(w + 2 * width, workers)], key_compare {});
+                });
+            }
+
+            // a key is kept when it differs from its predecessor, the first key of a chunk looks into the chunk before
+            std::vector<size_type> offsets(workers + 1);
+            std::vector<char> keeps_first(workers);
+            run_parallel(workers, [&](const size_type w) {
+                keeps_first[w] = w == 0 || !equivalent(keys[bounds[w] - 1], keys[bounds[w]]);
+                size_type kept {keeps_first[w] ? size_type {1} : 0};
+                for (size_type i {bounds[w] + 1}; i < bounds[w + 1]; ++i) {
+                    kept += equivalent(keys[i - 1], keys[i]) ? 0 : 1;
+                }
+                offsets[w + 1] = kept;
+            });
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+            const size_type n {offsets[workers]};
+
+            // leaves as in bulk_load, the first n % leaves of them take one key more
+            const size_type leaves {level_width(n, Node::max_size, Node::min_size)};
+            const size_type small {n / leaves};
+            const size_type large_keys {(small + 1) * (n % leaves)};
+            if (root != nullptr) {
+                release(root);
+                root = left_leaf = right_leaf = nullptr;
+            }
+            std::vector<ExternalNode *> chain(leaves, nullptr);
+            try {
+                for (size_type l {0}; l < leaves; ++l) {
+                    chain[l] = create_node<ExternalNode>(l > 0 ? chain[l - 1] : nullptr, nullptr);
+                    if (l > 0) {
+                        chain[l - 1]->right_neighbour = chain[l];
+                    }
+                    chain[l]->node_size = small + (l < n % leaves ? 1 : 0);
+                }
+                run_parallel(workers, [&](const size_type w) {
+                    const size_type first {offsets[w]};
+                    size_type l {first < large_keys ? first / (small + 1) : n % leaves + (first - large_keys) / small};
+                    size_type slot {first < large_keys ? first % (small + 1) : (first - large_keys) % small};
+                    const key_type *previous {nullptr};
+                    for (size_type i {bounds[w]}; i < bounds[w + 1]; ++i) {
+                        // keys before the first one moved in are untouched and can still be compared in place
+                        if (i == bounds[w] ? !keeps_first[w] : equivalent(previous != nullptr ? *previous : keys[i - 1], keys[i])) {
+                            continue;
+                        }
+                        if (slot == chain[l]->node_size) {
+                            ++l;
+                            slot = 0;
+                        }
+                        chain[l]->values[slot] = std::move(keys[i]);
+                        previous = &chain[l]->values[slot++];
+                    }
+                });
+            } catch (...) {
+                for (ExternalNode *leaf: chain) {
+                    if (leaf != nullptr) {
+                        destroy_node(leaf);
+                    }
+                }
+                throw;
+            }
+
+            std::vector<std::pair<Node *, key_type>> level;
+            level.reserve(leaves);
+            for (ExternalNode *leaf: chain) {
+                level.emplace_back(leaf, leaf->values[0]);
+            }
+            left_leaf = chain.front();
+            build_levels(std::move(level));
+            right_leaf = chain.back();
+            sz = n;
+        }
+
+        // appends strictly ascending keys to the leaf chain of an empty set, every leaf is filled up to max_size
+        struct LeafSink {
+                ADS_set &tree;
+                ExternalNode *leaf;
+
+                explicit LeafSink(ADS_set &target): tree {target}, leaf {nullptr} {}
+
+                void append(const key_type *first, const key_type *last) {
+                    while (first != last) {
+                        if (leaf == nullptr) {
+                            leaf = tree.left_leaf = tree.create_node<ExternalNode>();
+                        } else if (leaf->node_size == Node::max_size) {
+                            leaf->right_neighbour = tree.create_node<ExternalNode>(leaf, nullptr);
+                            leaf = leaf->right_neighbour;
+                        }
+                        const size_type n {std::min(static_cast<size_type>(last - first), Node::max_size - leaf->node_size)};
+                        std::copy(first, first + n, leaf->values + leaf->node_size);
+                        leaf->node_size += n;
+                        tree.sz += n;
+                        first += n;
+                    }
+                }
+
+                void finish() {
+                    if (leaf != nullptr) {
+                        tree.build_from_leaves(leaf);
+                        leaf = nullptr;
+                    }
+                }
+
+                // a chain that was never finished (say a copy or a predicate threw) has no tree on top, it is freed here
+                ~LeafSink() {
+                    if (leaf == nullptr) {
+                        return;
+                    }
+                    for (ExternalNode *chained {tree.left_leaf}; chained != nullptr;) {
+                        ExternalNode *next {chained->right_neighbour};
+                        tree.destroy_node(chained);
+                        chained = next;
+                    }
+                    tree.left_leaf = tree.right_leaf = nullptr;
+                    tree.sz = 0;
+                }
+        };
+
+        // read position in the leaf chain of a set; leaf becomes nullptr once the chain is exhausted
+        struct LeafCursor {
+                const ExternalNode *leaf;
+                size_type slot;
+
+                explicit LeafCursor(const ADS_set &tree): leaf {tree.sz == 0 ? nullptr : tree.left_leaf}, slot {0} {}
+
+                const key_type &key() const {
+                    return leaf->values[slot];
+                }
+
+                void next() {
+                    if (++slot >= leaf->node_size) {
+                        leaf = leaf->right_neighbour;
+                        slot = 0;
+                    }
+                }
+
+                // skips to the first key not less than bound; a run longer than the next leaf is skipped with one descent
+                void seek(const key_type &bound, const ADS_set &tree) {
+                    if (key_compare {}(leaf->values[leaf->node_size - 1], bound)) {
+                        const ExternalNode *right {leaf->right_neighbour};
+                        if (right != nullptr && key_compare {}(right->values[right->node_size - 1], bound)) {
+                            right = tree.find_leaf(bound);
+                        }
+                        leaf = right;
+                        slot = 0;
+                        if (leaf == nullptr) {
+                            return;
+                        }
+                    }
+                    slot = std::max(slot, leaf->lower_bound(bound));
+                    if (slot >= leaf->node_size) {
+                        leaf = leaf->right_neighbour;
+                        slot = 0;
+                    }
+                }
+
+                // appends the keys less than bound (all remaining ones for nullptr) leaf by leaf
+                void copy_below(const key_type *bound, LeafSink &sink) {
+                    while (leaf != nullptr && (bound == nullptr || key_compare {}(key(), *bound))) {
+                        size_type run {leaf->node_size};
+                        if (bound != nullptr && !key_compare {}(leaf->values[run - 1], *bound)) {
+                            run = leaf->lower_bound(*bound);
+                        }
+                        sink.append(leaf->values + slot, leaf->values + run);
+                        slot = run;
+                        if (slot >= leaf->node_size) {
+                            leaf = leaf->right_neighbour;
+                            slot = 0;
+                        }
+                    }
+                }
+        };
+
+        // walks both leaf chains in lockstep and bulk loads the result, linear in the keys that are copied
+        static ADS_set combine(const ADS_set &lhs, const ADS_set &rhs, const SetOperation operation, const allocator_type &allocator) {
+            ADS_set result {allocator};
+            LeafSink sink {result};
+            LeafCursor l {lhs};
+            LeafCursor r {rhs};
+            while (l.leaf != nullptr && r.leaf != nullptr) {
+                if (key_compare {}(l.key(), r.key())) {
+                    if (operation == SetOperation::INTERSECTION) {
+                        l.seek(r.key(), lhs);
+                    } else {
+                        l.copy_below(&r.key(), sink);
+                    }
+                } else if (key_compare {}(r.key(), l.key())) {
+                    if (operation == SetOperation::UNION) {
+                        r.copy_below(&l.key(), sink);
+                    } else {
+                        r.seek(l.key(), rhs);
+                    }
+                } else {
+                    if (operation != SetOperation::DIFFERENCE) {
+                        sink.append(&l.key(), &l.key() + 1);
+                    }
+                    l.next();
+                    r.next();
+                }
+            }
+            if (operation != SetOperation::INTERSECTION) {
+                l.copy_below(nullptr, sink);
+            }
+            if (operation == SetOperation::UNION) {
+                r.copy_below(nullptr, sink);
+            }
+            sink.finish();
+            return result;
+        }
+
+        // number of probes an unsorted batch lookup walks down the tree side by side
+        static constexpr size_type batch_width {8};
+
+        static void prefetch_node(const Node *node) {
+            const char *line {reinterpret_cast<const char *>(node)};
+            for (size_type offset {0}; offset < sizeof(Node) && offset < 4 * 64; offset += 64) {
+                ADS_SET_PREFETCH(line + offset);
+            }
+        }
+
+        // merge join of the ascending probes [first, last) against the subtree; emit gets (leaf, slot or -1) per probe
+        template<typename ForwardIt, typename Emit>
+        void lookup_sorted(const Node *node, ForwardIt first, const ForwardIt last, Emit &emit) const {
+            if (node->is_leaf()) {
+                const ExternalNode *leaf {static_cast<const ExternalNode *>(node)};
+                size_type slot {0};
+                for (; first != last; ++first) {
+                    while (slot < leaf->node_size && key_compare {}(leaf->values[slot], *first)) {
+                        ++slot;
+                    }
+                    emit(leaf, slot < leaf->node_size && !key_compare {}(*first, leaf->values[slot]) ? static_cast<int>(slot) : -1);
+                }
+                return;
+            }
+            const InternalNode *internal {static_cast<const InternalNode *>(node)};
+            while (first != last) {
+                // every probe up to the next separator shares the child
+                const size_type child {internal->find_pos(*first)};
+                ForwardIt split {first};
+                while (split != last && (child == internal->node_size || key_compare {}(*split, internal->values[child]))) {
+                    ++split;
+                }
+                lookup_sorted(internal->children[child], first, split, emit);
+                first = split;
+            }
+        }
+
+        // walks batch_width probes down level by level and prefetches their next nodes so the misses overlap
+        template<typename ForwardIt, typename Emit>
+        void lookup_interleaved(ForwardIt first, const ForwardIt last, Emit &emit) const {
+            const key_type *probes[batch_width];
+            const Node *nodes[batch_width];
+            while (first != last) {
+                size_type width {0};
+                for (; width < batch_width && first != last; ++width, ++first) {
+                    probes[width] = &*first;
+                    nodes[width] = root;
+                }
+                // all leaves are on the same level
+                while (!nodes[0]->is_leaf()) {
+                    for (size_type i {0}; i < width; ++i) {
+                        const InternalNode *internal {static_cast<const InternalNode *>(nodes[i])};
+                        nodes[i] = internal->children[internal->find_pos(*probes[i])];
+                        prefetch_node(nodes[i]);
+                    }
+                }
+                for (size_type i {0}; i < width; ++i) {
+                    const ExternalNode *leaf {static_cast<const ExternalNode *>(nodes[i])};
+                    emit(leaf, leaf->find_pos(*probes[i]));
+                }
+            }
+        }
+
+        template<typename InputIt, typename Emit>
+        void lookup_many(InputIt first, const InputIt last, Emit emit) const {
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+                if (root == nullptr) {
+                    for (; first != last; ++first) {
+                        emit(nullptr, -1);
+                    }
+                } else if (std::is_sorted(first, last, key_compare {})) {
+                    lookup_sorted(root, first, last, emit);
+                } else {
+                    lookup_interleaved(first, last, emit);
+                }
+            } else {
+                for (; first != last; ++first) {
+                    const ExternalNode *leaf {root == nullptr ? nullptr : find_leaf(*first)};
+                    emit(leaf, leaf == nullptr ? -1 : leaf->find_pos(*first));
+                }
+            }
+        }
+
+        // keys insert_buffered() collects before they go into the tree in one pass, and the ones it keeps apart until
+        // they are merged into the others (about a page of them)
+        static constexpr size_type write_buffer_size {size_type {1} << 16};
+        static constexpr size_type incoming_size {std::max<size_type>(64, 4096 / sizeof(key_type))};
+
+        // the keys of one leaf in a flush: they end at last, and next is the right neighbour leaf had when they were routed
+        struct Batch {
+                ExternalNode *leaf;
+                ExternalNode *next;
+                size_type last;
+        };
+
+        // routes the ascending keys [first, last) down the subtree, every node on the way is visited once for all of them
+        void route_sorted(Node *node, size_type first, const size_type last, const std::vector<key_type> &keys, std::vector<Batch> &batches) {
+            if (node->is_leaf()) {
+                ExternalNode *leaf {static_cast<ExternalNode *>(node)};
+                batches.push_back(Batch {leaf, leaf->right_neighbour, last});
+                return;
+            }
+            InternalNode *internal {static_cast<InternalNode *>(node)};
+            while (first != last) {
+                const size_type child {internal->find_pos(keys[first])};
+                const size_type split {child == internal->node_size
+                                           ? last
+                                           : static_cast<size_type>(std::lower_bound(keys.begin() + static_cast<difference_type>(first) + 1,
+                                                                                     keys.begin() + static_cast<difference_type>(last),
+                                                                                     internal->values[child], key_compare {})
+                                                                    - keys.begin())};
+                route_sorted(internal->children[child], first, split, keys, batches);
+                first = split;
+            }
+        }
+
+        // position of key in the ascending run, or its end
+        template<typename Run, typename K>
+        static auto find_in(Run &run, const K &key) {
+            const auto it {std::lower_bound(run.begin(), run.end(), key, key_compare {})};
+            return it == run.end() || key_compare {}(key, *it) ? run.end() : it;
+        }
+
+        template<typename K>
+        bool is_pending(const K &key) const {
+            return find_in(incoming, key) != incoming.end() || find_in(pending, key) != pending.end();
+        }
+
+        size_type erase_pending(const key_type &key) {
+            size_type erased {0};
+            for (std::vector<key_type> *run: {&incoming, &pending}) {
+                if (const auto it {find_in(*run, key)}; it != run->end()) {
+                    run->erase(it);
+                    erased = 1;
+                }
+            }
+            return erased;
+        }
+
+        // number of buffered keys not in the tree, keys in incoming and pending are counted once
+        size_type buffered_count() const {
+            size_type n {0};
+            for (const key_type &key: pending) {
+                n += root == nullptr || find_leaf(key)->find_pos(key) == -1 ? 1 : 0;
+            }
+            for (const key_type &key: incoming) {
+                n += find_in(pending, key) == pending.end() && (root == nullptr || find_leaf(key)->find_pos(key) == -1) ? 1 : 0;
+            }
+            return n;
+        }
+
+        // takes the buffered keys in [from, to) out of the buffer, up to the end of it without a to
+        void erase_pending(const key_type &from, const key_type *to) {
+            for (std::vector<key_type> *run: {&incoming, &pending}) {
+                const auto first {std::lower_bound(run->begin(), run->end(), from, key_compare {})};
+                run->erase(first, to == nullptr ? run->end() : std::lower_bound(first, run->end(), *to, key_compare {}));
+            }
+        }
+
+        // calls f for every key in ascending order, the buffered ones included
+        template<typename F>
+        void for_each_key(F &&f) const {
+            if (pending.empty() && incoming.empty()) {
+                for (const key_type &key: *this) {
+                    f(key);
+                }
+                return;
+            }
+            std::vector<key_type> buffered;
+            buffered.reserve(pending.size() + incoming.size());
+            std::set_union(pending.begin(), pending.end(), incoming.begin(), incoming.end(), std::back_inserter(buffered), key_compare {});
+            auto it {begin()};
+            auto next {buffered.cbegin()};
+            while (it != end() || next != buffered.cend()) {
+                if (next == buffered.cend() || (it != end() && key_compare {}(*it, *next))) {
+                    f(*it++);
+                } else {
+                    if (it != end() && !key_compare {}(*next, *it)) {
+                        ++it;
+                    }
+                    f(*next++);
+                }
+            }
+        }
+
+        // merges incoming into pending, keys in both are kept once
+        void merge_incoming() {
+            std::vector<key_type> merged;
+            merged.reserve(pending.size() + incoming.size());
+            std::set_union(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()), std::make_move_iterator(incoming.begin()),
+                           std::make_move_iterator(incoming.end()), std::back_inserter(merged), key_compare {});
+            pending.swap(merged);
+            incoming.clear();
+        }
+
+        template<typename K>
+        void buffer_key(K &&key) {
+            const auto it {std::lower_bound(incoming.begin(), incoming.end(), key, key_compare {})};
+            if (it == incoming.end() || key_compare {}(key, *it)) {
+                incoming.insert(it, std::forward<K>(key));
+            }
+            if (incoming.size() >= incoming_size) {
+                merge_incoming();
+                if (pending.size() >= write_buffer_size) {
+                    flush();
+                }
+            }
+        }
+
+        // key is a const key_type & or a key_type &&, it is moved from only when it goes in
+        template<typename K>
+        std::pair<iterator, bool> insert_key(K &&key) {
+            flush();
+            if (root == nullptr) {
+                root = left_leaf = right_leaf = create_node<ExternalNode>();
+            }
+            ExternalNode *leaf {find_leaf(key)};
+            if (shared) {
+                // the path is only copied if the key really goes in
+                if (const int i {leaf->find_pos(key)}; i != -1) {
+                    return std::pair<iterator, bool> {Iterator(this, leaf, static_cast<size_type>(i)), false};
+                }
+                leaf = own_path(root, key);
+            }
+            size_type slot {0};
+            switch (leaf->add_elem(std::forward<K>(key), slot)) {
+                case InsertMsg::EXISTS:
+                    TRACE("Existing Element found")
+                    return std::pair<iterator, bool> {Iterator(this, leaf, slot), false};
+                case InsertMsg::SUCCESS:
+                    ++sz;
+                    count_upwards(leaf, 1);
+                    return std::pair<iterator, bool> {Iterator(this, leaf, slot), true};
+                case InsertMsg::SPLIT:
+                    ++sz;
+                    count_upwards(leaf, 1);
+                    split_upwards(leaf, slot);
+                    return std::pair<iterator, bool> {Iterator(this, leaf, slot), true};
+            }
+            TRACE("You messed up big time! (ADS_set::insert(key) got to the end!)");
+            return std::pair<iterator, bool> {Iterator(this), true}; // will never be reached
+        }
+
+        // inserts right before hint without a descent if key belongs there, otherwise like insert(key)
+        template<typename K>
+        iterator insert_hinted(const const_iterator hint, K &&key) {
+            // flushing can split the leaf the hint points into, so buffered keys send the key down from the root
+            if (root == nullptr || shared || !pending.empty() || !incoming.empty()) {
+                return insert_key(std::forward<K>(key)).first;
+            }
+            ExternalNode *leaf {hint.current_node == nullptr ? right_leaf : const_cast<ExternalNode *>(hint.current_node)};
+            size_type slot {hint.current_node == nullptr ? right_leaf->node_size : hint.current_element};
+            // the slot in front of a leaf is only safe at the left end, otherwise the separator decides
+            if ((slot == 0 && leaf->left_neighbour != nullptr) || (slot > 0 && !key_compare {}(leaf->values[slot - 1], key))
+                || (slot < leaf->node_size && !key_compare {}(key, leaf->values[slot]))) {
+                return insert_key(std::forward<K>(key)).first;
+            }
+            std::move_backward(leaf->values + slot, leaf->values + leaf->node_size, leaf->values + leaf->node_size + 1);
+            leaf->values[slot] = std::forward<K>(key);
+            ++leaf->node_size;
+            ++sz;
+            count_upwards(leaf, 1);
+            split_upwards(leaf, slot);
+            return Iterator(this, leaf, slot);
+        }
+
+    public:
+        // nodes are allocated lazily, an empty set may have no root at all
+        ADS_set() noexcept(noexcept(Allocator())): ADS_set(Allocator()) {}
+
+        explicit ADS_set(const allocator_type &allocator) noexcept
+            : alloc {allocator}, sz {0}, root {nullptr}, left_leaf {nullptr}, right_leaf {nullptr}, shared {false}, relaxed_erase {false} {}
+
+        ADS_set(std::initializer_list<key_type> ilist): ADS_set() {
+            for (const auto &elem: ilist) {
+                insert(elem);
+            }
+        }
+
+        template<typename InputIt>
+        ADS_set(InputIt first, InputIt last): ADS_set() {
+            insert(first, last);
+        }
+
+        // leaf_fill is the number of keys each leaf gets, between N and 2N
+        template<typename InputIt>
+        ADS_set(sorted_unique_t, InputIt first, InputIt last, size_type leaf_fill = Node::max_size): ADS_set() {
+            bulk_load(first, last, leaf_fill);
+        }
+
+        // keys in any order, sorted and loaded by policy.threads workers
+        template<typename InputIt>
+        ADS_set(parallel_t policy, InputIt first, InputIt last): ADS_set() {
+            insert(policy, first, last);
+        }
+
+        // clones the node structure of other, no rebalancing needed
+        ADS_set(const ADS_set &other): ADS_set(alloc_traits::select_on_container_copy_construction(other.alloc)) {
+            relaxed_erase = other.relaxed_erase;
+            pending = other.pending;
+            incoming = other.incoming;
+            if (other.root == nullptr) {
+                return;
+            }
+            sz = other.sz;
+            ExternalNode *last_leaf {nullptr};
+            root = clone_subtree(other.root, last_leaf);
+            Node *node {root};
+            while (!node->is_leaf()) {
+                node = static_cast<InternalNode *>(node)->children[0];
+            }
+            left_leaf = static_cast<ExternalNode *>(node);
+            right_leaf = last_leaf;
+        }
+
+        // takes over the tree of other and leaves it empty without nodes; both keep the allocator
+        ADS_set(ADS_set &&other) noexcept
+            : alloc {other.alloc}, sz {other.sz}, root {other.root}, left_leaf {other.left_leaf}, right_leaf {other.right_leaf},
+              shared {other.shared}, relaxed_erase {other.relaxed_erase}, pending {std::move(other.pending)},
+              incoming {std::move(other.incoming)} {
+            other.pending.clear();
+            other.incoming.clear();
+            other.sz = 0;
+            other.root = nullptr;
+            other.left_leaf = nullptr;
+            other.right_leaf = nullptr;
+            other.shared = false;
+        }
+
+        ~ADS_set() {
+            destroy_tree();
+        };
+
+        ADS_set &operator=(const ADS_set &other) {
+            if (this == &other) {
+                return *this;
+            }
+            ADS_set copy {other};
+            swap(copy);
+            return *this;
+        }
+
+        ADS_set &operator=(ADS_set &&other) noexcept {
+            ADS_set moved {std::move(other)};
+            swap(moved);
+            return *this;
+        }
+
+        ADS_set &operator=(std::initializer_list<key_type> ilist) {
+            clear();
+            insert(ilist);
+            return *this;
+        }
+
+        // with keys buffered, each of them is looked up in the tree (it may be there already)
+        size_type size() const {
+            return sz + buffered_count();
+        }
+
+        bool empty() const {
+            return sz == 0 && pending.empty() && incoming.empty();
+        }
+
+        void insert(std::initializer_list<key_type> ilist) {
+            for (const auto &elem: ilist) {
+                insert(elem);
+            }
+        }
+
+        std::pair<iterator, bool> insert(const key_type &key) {
+            return insert_key(key);
+        }
+
+        std::pair<iterator, bool> insert(key_type &&key) {
+            return insert_key(std::move(key));
+        }
+
+        // the key is built once and then moved into its slot
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args &&...args) {
+            return insert_key(key_type(std::forward<Args>(args)...));
+        }
+
+        iterator insert(const_iterator hint, const key_type &key) {
+            return insert_hinted(hint, key);
+        }
+
+        iterator insert(const_iterator hint, key_type &&key) {
+            return insert_hinted(hint, std::move(key));
+        }
+
+        template<typename... Args>
+        iterator emplace_hint(const_iterator hint, Args &&...args) {
+            return insert_hinted(hint, key_type(std::forward<Args>(args)...));
+        }
+
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            flush();
+            if (sz == 0 && is_strictly_ascending(first, last)) {
+                bulk_load(first, last, Node::max_size);
+                return;
+            }
+            for (; first != last; ++first) {
+                insert(*first);
+            }
+        }
+
+        template<typename InputIt>
+        void insert(sorted_unique_t, InputIt first, InputIt last, size_type leaf_fill = Node::max_size) {
+            flush();
+            if (sz == 0) {
+                bulk_load(first, last, leaf_fill);
+                return;
+            }
+            for (; first != last; ++first) {
+                insert(*first);
+            }
+        }
+
+        // sorts and deduplicates the keys with policy.threads workers; a set that is not empty is then rebuilt in one
+        // linear pass over both leaf chains
+        template<typename InputIt>
+        void insert(parallel_t policy, InputIt first, InputIt last) {
+            std::vector<key_type> keys(first, last);
+            flush();
+            if (sz == 0) {
+                parallel_load(keys, policy.threads);
+                return;
+            }
+            ADS_set loaded {alloc};
+            loaded.parallel_load(keys, policy.threads);
+            ADS_set merged {combine(*this, loaded, SetOperation::UNION, alloc)};
+            swap(merged);
+        }
+
+        // write optimized insert: the key waits in a sorted buffer of up to write_buffer_size keys, which goes into the
+        // tree in one batch when it is full. the batch is routed down the tree once and then merged into the leaves it
+        // reaches. count(), contains(), size(), empty() and save() see the buffered keys, as find() does on a non-const set
+        // (it flushes first); erase() takes them out of the buffer. the other const members, iteration included, see the
+        // tree only until flush(). members that add keys to the tree or move them between sets flush first
+        void insert_buffered(const key_type &key) {
+            buffer_key(key);
+        }
+
+        void insert_buffered(key_type &&key) {
+            buffer_key(std::move(key));
+        }
+
+        // moves the buffered keys into the tree
+        void flush() {
+            if (!incoming.empty()) {
+                merge_incoming();
+            }
+            if (pending.empty()) {
+                return;
+            }
+            std::vector<key_type> keys;
+            keys.swap(pending);
+            if (shared) {
+                for (auto &key: keys) {
+                    insert_key(std::move(key));
+                }
+            } else if (sz == 0) {
+                bulk_load(keys.begin(), keys.end(), Node::max_size);
+            } else {
+                std::vector<Batch> batches;
+                route_sorted(root, 0, keys.size(), keys, batches);
+                size_type i {0};
+                for (const Batch &batch: batches) {
+                    ExternalNode *leaf {batch.leaf};
+                    for (; i < batch.last; ++i) {
+                        // leaves split off during the flush start with their separator
+                        while (leaf->right_neighbour != batch.next && !key_compare {}(keys[i], leaf->right_neighbour->values[0])) {
+                            leaf = leaf->right_neighbour;
+                        }
+                        size_type slot {0};
+                        const InsertMsg msg {leaf->add_elem(std::move(keys[i]), slot)};
+                        if (msg != InsertMsg::EXISTS) {
+                            ++sz;
+                            count_upwards(leaf, 1);
+                        }
+                        if (msg == InsertMsg::SPLIT) {
+                            split_upwards(leaf, slot);
+                        }
+                    }
+                }
+            }
+        }
+
+        // frees all nodes and leaves the set without any, like a new one; nothing is allocated
+        void clear() {
+            pending.clear();
+            incoming.clear();
+            destroy_tree();
+            sz = 0;
+            shared = false;
+            root = left_leaf = right_leaf = nullptr;
+        }
+
+        // like clear(), but the nodes are freed by a new thread, so the caller does not wait for a large tree to be torn
+        // down; the future is ready once they are. allocators with state (a node pool, say) need not be safe to use from
+        // two threads, with those the nodes are freed right here, as they are if the thread cannot be started
+        std::future<void> clear_async() {
+            std::promise<void> done;
+            std::future<void> freed {done.get_future()};
+            if constexpr (alloc_traits::is_always_equal::value) {
+                if (root != nullptr) {
+                    pending.clear();
+                    incoming.clear();
+                    try {
+                        std::thread {[taken = ADS_set {std::move(*this)}, done = std::move(done)]() mutable {
+                            taken.clear();
+                            done.set_value();
+                        }}.detach();
+                    } catch (const std::system_error &) {
+                        // the nodes went along with the thread's arguments, which are gone already
+                        std::promise<void> inline_done;
+                        inline_done.set_value();
+                        return inline_done.get_future();
+                    }
+                    return freed;
+                }
+            }
+            clear();
+            done.set_value();
+            return freed;
+        }
+
+        size_type erase(const key_type &key) {
+            // a buffered key may be in the tree as well
+            const size_type buffered {erase_pending(key)};
+            if (root == nullptr) {
+                return buffered;
+            }
+            ExternalNode *leaf {find_leaf(key)};
+            if (shared) {
+                if (leaf->find_pos(key) == -1) {
+                    return buffered;
+                }
+                leaf = own_path(root, key);
+            }
+            switch (leaf->remove_elem(key)) {
+                case EraseMsg::SUCCESS:
+                    --sz;
+                    count_upwards(leaf, -1);
+                    return 1;
+                case EraseMsg::NOT_EXISTENT:
+                    return buffered;
+                case EraseMsg::MERGE:
+                    --sz;
+                    count_upwards(leaf, -1);
+                    leaf_underflow(leaf);
+                    return 1;
+            }
+            return 2; // should never be reached
+        }
+
+        // erases the key at pos without a descent and returns the iterator to the key after it
+        iterator erase(const_iterator pos) {
+            // the key may be buffered again
+            erase_pending(*pos);
+            if (shared) {
+                const key_type key {*pos};
+                erase(key);
+                return upper_bound(key);
+            }
+            ExternalNode *leaf {const_cast<ExternalNode *>(pos.current_node)};
+            const size_type slot {pos.current_element};
+            --sz;
+            count_upwards(leaf, -1);
+            if (leaf->remove_at(slot) == EraseMsg::SUCCESS || leaf->parent == nullptr || (relaxed_erase && leaf->node_size > 0)) {
+                return leaf_iterator(leaf, slot);
+            }
+            // merging moves keys between leaves, so the successor is looked up again afterwards
+            const ExternalNode *next {slot < leaf->node_size ? leaf : leaf->right_neighbour};
+            if (next == nullptr) {
+                leaf_underflow(leaf);
+                return end();
+            }
+            const key_type successor {next->values[next == leaf ? slot : 0]};
+            leaf_underflow(leaf);
+            return std::as_const(*this).find(successor);
+        }
+
+        // erases [first, last) by cutting the tree at both ends and joining the outer parts again; apart from the two
+        // paths only the nodes in between are visited (to free them)
+        iterator erase(const_iterator first, const_iterator last) {
+            if (first == last) {
+                return last;
+            }
+            // cutting moves keys around, so the bounds are taken beforehand
+            const key_type from {*first};
+            if (last == end()) {
+                erase_pending(from, nullptr);
+                if (shared) {
+                    own_path(root, from);
+                }
+                auto [low, rest] {split_subtree(whole_tree(), from)};
+                sz -= rest.node == nullptr ? 0 : count_keys(rest.node);
+                destroy_subtree(rest.node);
+                adopt_tree(low);
+                return end();
+            }
+            const key_type to {*last};
+            erase_pending(from, &to);
+            if (shared) {
+                own_path(root, from);
+            }
+            auto [low, rest] {split_subtree(whole_tree(), from)};
+            if (shared) {
+                own_path(rest.node, to);
+            }
+            auto [middle, high] {split_subtree(rest, to)};
+            // the erased keys are counted here, on the cut off part only
+            sz -= middle.node == nullptr ? 0 : count_keys(middle.node);
+            destroy_subtree(middle.node);
+            if (low.node != nullptr) {
+                ExternalNode *seam_left {edge_leaf(low.node, true)};
+                ExternalNode *seam_right {edge_leaf(high.node, false)};
+                seam_left->right_neighbour = seam_right;
+                seam_right->left_neighbour = seam_left;
+            }
+            adopt_tree(join_subtrees(low, to, high));
+            return lower_bound(to);
+        }
+
+        // with relaxed erase, a leaf may drop below min_size and is only fused with a sibling once it is empty, so
+        // alternating erase and insert of the same keys does not merge and split the same leaves over and over.
+        // compact() brings the leaves back into shape later; switching relaxed erase off compacts right away
+        void set_relaxed(const bool on) {
+            relaxed_erase = on;
+            if (!on) {
+                compact();
+            }
+        }
+
+        bool relaxed() const {
+            return relaxed_erase;
+        }
+
+        // evens out every leaf below min_size with a sibling or fuses the two, in one pass along the leaf chain. leaves
+        // that are in shape are only looked at, each one below min_size costs one rebalance and its merges upwards
+        void compact() {
+            if (root == nullptr || root->is_leaf()) {
+                return;
+            }
+            ExternalNode *leaf {left_leaf};
+            while (leaf != nullptr) {
+                if (leaf->node_size >= Node::min_size || leaf->parent == nullptr) {
+                    leaf = leaf->right_neighbour;
+                    continue;
+                }
+                if (shared) {
+                    leaf = own_path(root, leaf->values[0]);
+                }
+                // the left leaf of the pair is looked at again, a fusion of two small leaves may still be too small
+                leaf = rebalance_leaf(leaf);
+            }
+        }
+
+        // erases every key pred holds for in a single pass; the remaining keys are packed into the leading leaves and
+        // the internal levels are rebuilt on top. nothing changes if no key matches
+        template<typename Pred>
+        size_type erase_if(Pred pred) {
+            flush();
+            if (sz == 0) {
+                return 0;
+            }
+            if (shared) {
+                // shared leaves cannot be packed in place, the remaining keys go into a new tree. nothing is copied
+                // before the first match, the keys in front of it are then taken over without asking pred again
+                const ExternalNode *first {left_leaf};
+                size_type first_slot {0};
+                for (; first != nullptr; first = first->right_neighbour) {
+                    for (first_slot = 0; first_slot < first->node_size && !pred(std::as_const(first->values[first_slot])); ++first_slot) {
+                    }
+                    if (first_slot < first->node_size) {
+                        break;
+                    }
+                }
+                if (first == nullptr) {
+                    return 0;
+                }
+                ADS_set kept {alloc};
+                LeafSink sink {kept};
+                for (const ExternalNode *leaf {left_leaf}; leaf != first; leaf = leaf->right_neighbour) {
+                    sink.append(leaf->values, leaf->values + leaf->node_size);
+                }
+                sink.append(first->values, first->values + first_slot);
+                size_type erased {1};
+                for (const ExternalNode *leaf {first}; leaf != nullptr; leaf = leaf->right_neighbour) {
+                    for (size_type i {leaf == first ? first_slot + 1 : 0}; i < leaf->node_size; ++i) {
+                        if (pred(std::as_const(leaf->values[i]))) {
+                            ++erased;
+                        } else {
+                            sink.append(leaf->values + i, leaf->values + i + 1);
+                        }
+                    }
+                }
+                sink.finish();
+                swap(kept);
+                return erased;
+            }
+            ExternalNode *out {left_leaf};
+            size_type out_slot {0};
+            size_type erased {0};
+            for (ExternalNode *in {left_leaf}; in != nullptr; in = in->right_neighbour) {
+                for (size_type i {0}; i < in->node_size; ++i) {
+                    if (pred(std::as_const(in->values[i]))) {
+                        ++erased;
+                        continue;
+                    }
+                    // keys in front of the first match stay where they are
+                    if (erased == 0) {
+                        out = in;
+                        out_slot = i + 1;
+                        continue;
+                    }
+                    // writing never overtakes reading, leaves are only left once they are full
+                    if (out_slot == Node::max_size) {
+                        out->node_size = out_slot;
+                        out = out->right_neighbour;
+                        out_slot = 0;
+                    }
+                    if (out != in || out_slot != i) {
+                        out->values[out_slot] = std::move(in->values[i]);
+                    }
+                    ++out_slot;
+                }
+            }
+            if (erased == 0) {
+                return 0;
+            }
+            sz -= erased;
+            if (sz == 0) {
+                destroy_tree();
+                root = left_leaf = right_leaf = nullptr;
+                return erased;
+            }
+            destroy_internal_nodes(root);
+            out->node_size = out_slot;
+            for (ExternalNode *leaf {out->right_neighbour}; leaf != nullptr;) {
+                ExternalNode *next {leaf->right_neighbour};
+                destroy_node(leaf);
+                leaf = next;
+            }
+            out->right_neighbour = nullptr;
+            build_from_leaves(out);
+            return erased;
+        }
+
+        // moves the keys not less than key into the returned set, which shares the allocator, and keeps the others.
+        // the tree is cut along the path to key in O(log n); sizing both parts walks the leaves of the smaller one only,
+        // unless the set is Ranked
+        ADS_set split_at(const key_type &key) {
+            ADS_set upper {alloc};
+            flush();
+            if (sz == 0) {
+                return upper;
+            }
+            if (shared) {
+                own_path(root, key);
+                upper.shared = true;
+            }
+            auto [low, high] {split_subtree(whole_tree(), key)};
+            adopt_tree(low);
+            upper.adopt_tree(high);
+            if constexpr (Ranked) {
+                upper.sz = high.node == nullptr ? 0 : InternalNode::keys_below(high.node);
+                sz -= upper.sz;
+                return upper;
+            }
+            size_type lower_keys {0};
+            size_type upper_keys {0};
+            const ExternalNode *l {left_leaf};
+            const ExternalNode *u {upper.left_leaf};
+            for (; l != nullptr && u != nullptr; l = l->right_neighbour, u = u->right_neighbour) {
+                lower_keys += l->node_size;
+                upper_keys += u->node_size;
+            }
+            upper.sz = l == nullptr ? sz - lower_keys : upper_keys;
+            sz -= upper.sz;
+            return upper;
+        }
+
+        // appends other, whose keys all have to be greater than the keys of this set, and leaves it empty. the lower
+        // tree is grafted into the spine of the higher one and the leaf chains are linked at the seam, O(log n).
+        // with an allocator that cannot free the nodes of other the keys are appended one by one instead
+        void join(ADS_set &&other) {
+            flush();
+            other.flush();
+            if (this == &other || other.sz == 0) {
+                return;
+            }
+            TRACE_IF(sz > 0 && !key_compare {}(right_leaf->values[right_leaf->node_size - 1], other.left_leaf->values[0]),
+                     "join was called with keys that are not greater than the ones in the set!");
+            ADS_set taken {std::move(other)};
+            if (!(alloc == taken.alloc)) {
+                for (const auto &elem: taken) {
+                    insert(end(), elem);
+                }
+                return;
+            }
+            if (sz == 0) {
+                destroy_subtree(root);
+                root = nullptr;
+            } else {
+                right_leaf->right_neighbour = taken.left_leaf;
+                taken.left_leaf->left_neighbour = right_leaf;
+            }
+            shared = shared || taken.shared;
+            adopt_tree(join_subtrees(whole_tree(), taken.left_leaf->values[0], taken.whole_tree()));
+            sz += taken.sz;
+            taken.sz = 0;
+            taken.root = taken.left_leaf = taken.right_leaf = nullptr;
+        }
+
+        // the key_type overloads forward to the templates, which also take any K a transparent key_compare compares
+        size_type count(const key_type &key) const {
+            return count<key_type>(key);
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        size_type count(const K &key) const {
+            if (is_pending(key) || (root != nullptr && find_leaf(key)->find_pos(key) != -1)) {
+                return 1;
+            }
+            return 0;
+        }
+
+        bool contains(const key_type &key) const {
+            return count<key_type>(key) != 0;
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        bool contains(const K &key) const {
+            return count(key) != 0;
+        }
+
+        iterator find(const key_type &key) const {
+            return find<key_type>(key);
+        }
+
+        // the buffered keys are flushed first, so a key taken by insert_buffered() is found
+        iterator find(const key_type &key) {
+            return find<key_type>(key);
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        iterator find(const K &key) {
+            flush();
+            return std::as_const(*this).find(key);
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        iterator find(const K &key) const {
+            if (root == nullptr) {
+                return end();
+            }
+            const ExternalNode *leaf {find_leaf(key)};
+            if (const int i {leaf->find_pos(key)}; i != -1) {
+                return Iterator(this, leaf, static_cast<size_type>(i));
+            }
+            return end();
+        }
+
+        // first element not less than key
+        iterator lower_bound(const key_type &key) const {
+            return lower_bound<key_type>(key);
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        iterator lower_bound(const K &key) const {
+            if (root == nullptr) {
+                return end();
+            }
+            const ExternalNode *leaf {find_leaf(key)};
+            return leaf_iterator(leaf, leaf->lower_bound(key));
+        }
+
+        // first element greater than key
+        iterator upper_bound(const key_type &key) const {
+            return upper_bound<key_type>(key);
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        iterator upper_bound(const K &key) const {
+            if (root == nullptr) {
+                return end();
+            }
+            const ExternalNode *leaf {find_leaf(key)};
+            return leaf_iterator(leaf, leaf->upper_bound(key));
+        }
+
+        std::pair<iterator, iterator> equal_range(const key_type &key) const {
+            return equal_range<key_type>(key);
+        }
+
+        template<typename K, if_lookup_with<K> = 0>
+        std::pair<iterator, iterator> equal_range(const K &key) const {
+            iterator first {lower_bound(key)};
+            iterator last {first};
+            if (last != end() && !key_compare {}(key, *last)) {
+                ++last;
+            }
+            return {first, last};
+        }
+
+        // all elements in [first, last); each bound costs one descent, the scan only compares iterators
+        Range range(const key_type &first, const key_type &last) const {
+            iterator from {lower_bound(first)};
+            if (!key_compare {}(first, last)) {
+                return Range(from, from);
+            }
+            return Range(from, lower_bound(last));
+        }
+
+        // writes count(key) for every probe to out, in probe order; sorted probes share one descent
+        template<typename InputIt, typename OutputIt>
+        OutputIt count_many(InputIt first, InputIt last, OutputIt out) const {
+            lookup_many(first, last, [&out](const ExternalNode *, const int slot) {
+                *out = slot == -1 ? 0 : 1;
+                ++out;
+            });
+            return out;
+        }
+
+        // writes find(key) for every probe to out, in probe order; sorted probes share one descent
+        template<typename InputIt, typename OutputIt>
+        OutputIt find_many(InputIt first, InputIt last, OutputIt out) const {
+            lookup_many(first, last, [this, &out](const ExternalNode *leaf, const int slot) {
+                *out = slot == -1 ? end() : Iterator(this, leaf, static_cast<size_type>(slot));
+                ++out;
+            });
+            return out;
+        }
+
+        // moves every key of source that is not in this set over, like std::set::merge; both sets are rebuilt in linear time
+        void merge(ADS_set &source) {
+            if (this == &source) {
+                return;
+            }
+            flush();
+            source.flush();
+            ADS_set merged {combine(*this, source, SetOperation::UNION, alloc)};
+            ADS_set left_over {combine(source, *this, SetOperation::INTERSECTION, source.alloc)};
+            swap(merged);
+            source.swap(left_over);
+        }
+
+        void merge(ADS_set &&source) {
+            merge(source);
+        }
+
+        // keys in this set or other; the result is bulk loaded straight from both leaf chains
+        ADS_set set_union(const ADS_set &other) const {
+            return combine(*this, other, SetOperation::UNION, alloc_traits::select_on_container_copy_construction(alloc));
+        }
+
+        // keys in this set and other; runs missing in the other set are galloped over
+        ADS_set set_intersection(const ADS_set &other) const {
+            return combine(*this, other, SetOperation::INTERSECTION, alloc_traits::select_on_container_copy_construction(alloc));
+        }
+
+        // keys in this set but not in other
+        ADS_set set_difference(const ADS_set &other) const {
+            return combine(*this, other, SetOperation::DIFFERENCE, alloc_traits::select_on_container_copy_construction(alloc));
+        }
+
+        // number of keys less than key
+        size_type rank(const key_type &key) const {
+            static_assert(Ranked, "rank() needs the subtree sizes of ADS_set<..., Ranked = true>");
+            if (root == nullptr) {
+                return 0;
+            }
+            size_type keys {0};
+            const Node *node {root};
+            while (!node->is_leaf()) {
+                const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                const size_type pos {internal->find_pos(key)};
+                for (size_type i {0}; i < pos; ++i) {
+                    keys += internal->sizes[i];
+                }
+                node = internal->children[pos];
+            }
+            return keys + node->lower_bound(key);
+        }
+
+        // iterator to the key with i smaller keys, end() if there are not that many
+        iterator select(size_type i) const {
+            static_assert(Ranked, "select() needs the subtree sizes of ADS_set<..., Ranked = true>");
+            if (i >= sz) {
+                return end();
+            }
+            const Node *node {root};
+            while (!node->is_leaf()) {
+                const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                size_type pos {0};
+                for (; i >= internal->sizes[pos]; ++pos) {
+                    i -= internal->sizes[pos];
+                }
+                node = internal->children[pos];
+            }
+            return Iterator(this, static_cast<const ExternalNode *>(node), i);
+        }
+
+        // number of keys in front of it, size() for end(); climbs the parent links of its leaf
+        size_type index_of(const_iterator it) const {
+            static_assert(Ranked, "index_of() needs the subtree sizes of ADS_set<..., Ranked = true>");
+            if (it.current_node == nullptr) {
+                return sz;
+            }
+            size_type index {it.current_element};
+            const Node *node {it.current_node};
+            for (const InternalNode *parent {node->parent}; parent != nullptr; node = parent, parent = parent->parent) {
+                const size_type pos {parent->child_pos(node)};
+                for (size_type i {0}; i < pos; ++i) {
+                    index += parent->sizes[i];
+                }
+            }
+            return index;
+        }
+
+        // std::distance(first, last) in O(log n)
+        difference_type distance(const_iterator first, const_iterator last) const {
+            return static_cast<difference_type>(index_of(last)) - static_cast<difference_type>(index_of(first));
+        }
+
+        // read-only view of the keys as they are now. it shares every node with the set, which copies the nodes on
+        // a root-to-leaf path before it writes to them from now on; the view stays valid until it is destroyed
+        Snapshot snapshot() {
+            flush();
+            shared = true;
+            return Snapshot(*this);
+        }
+
+        // writes the keys as a saved image: a header page, all keys back to back from the second page on, then a sparse
+        // index with the first key of every page of keys, buffered keys included. keys are stored in native byte order
+        void save(std::ostream &o) const {
+            static_assert(std::is_trivially_copyable_v<key_type>, "save() writes the key bytes and needs trivially copyable keys");
+            const size_type keys {size()};
+            const size_type stride {std::max<size_type>(1, image_page / sizeof(key_type))};
+            const size_type index_entries {(keys + stride - 1) / stride};
+            const size_type keys_end {image_page + keys * sizeof(key_type)};
+            ImageHeader header {};
+            std::memcpy(header.magic, image_magic, sizeof(header.magic));
+            header.version = image_version;
+            header.byte_order = image_byte_order;
+            header.key_size = sizeof(key_type);
+            header.key_align = alignof(key_type);
+            header.size = keys;
+            header.keys_offset = image_page;
+            header.index_offset = (keys_end + image_page - 1) / image_page * image_page;
+            header.index_stride = stride;
+            header.index_entries = index_entries;
+
+            const auto pad {[&o](size_type bytes) {
+                static constexpr char zeros[64] {};
+                for (; bytes > 0; bytes -= std::min<size_type>(bytes, sizeof(zeros))) {
+                    o.write(zeros, static_cast<std::streamsize>(std::min<size_type>(bytes, sizeof(zeros))));
+                }
+            }};
+            o.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            pad(image_page - sizeof(header));
+            if (pending.empty() && incoming.empty()) {
+                for (const ExternalNode *leaf {sz == 0 ? nullptr : left_leaf}; leaf != nullptr; leaf = leaf->right_neighbour) {
+                    o.write(reinterpret_cast<const char *>(leaf->values), static_cast<std::streamsize>(leaf->node_size * sizeof(key_type)));
+                }
+            } else {
+                for_each_key([&o](const key_type &key) { o.write(reinterpret_cast<const char *>(&key), sizeof(key_type)); });
+            }
+            pad(header.index_offset - keys_end);
+            size_type i {0};
+            for_each_key([&o, &i, stride](const key_type &key) {
+                if (i++ % stride == 0) {
+                    o.write(reinterpret_cast<const char *>(&key), sizeof(key_type));
+                }
+            });
+        }
+
+        void save(const std::string &path) const {
+            std::ofstream file {path, std::ios::binary | std::ios::trunc};
+            if (!file) {
+                throw std::system_error(errno, std::generic_category(), "ADS_set::save cannot open " + path);
+            }
+            save(file);
+            file.close();
+            if (!file) {
+                throw std::runtime_error("ADS_set::save could not write " + path);
+            }
+        }
+
+        // read-only view of an image written by save(); lookups and iteration run on the mapped pages, which are read
+        // from disk when they are first touched
+        static Mapped open_mapped(const std::string &path) {
+            static_assert(std::is_trivially_copyable_v<key_type>, "open_mapped() needs trivially copyable keys");
+            return Mapped(path);
+        }
+
+        // compact read-only copy of string keys: every leaf becomes a block holding the prefix its keys share once and
+        // only the suffixes after it, all in one character buffer
+        Packed pack() const {
+            static_assert(is_basic_string<key_type>::value, "pack() stores std::basic_string keys");
+            static_assert(std::is_same_v<key_compare, std::less<key_type>> || std::is_same_v<key_compare, std::less<>>,
+                          "pack() orders keys by their characters");
+            return Packed(*this);
+        }
+
+        key_compare key_comp() const {
+            return key_compare {};
+        }
+
+        value_compare value_comp() const {
+            return value_compare {};
+        }
+
+        allocator_type get_allocator() const {
+            return alloc;
+        }
+
+        void swap(ADS_set &other) noexcept {
+            using std::swap;
+            swap(this->alloc, other.alloc);
+            std::swap(this->root, other.root);
+            std::swap(this->sz, other.sz);
+            std::swap(this->left_leaf, other.left_leaf);
+            std::swap(this->right_leaf, other.right_leaf);
+            std::swap(this->shared, other.shared);
+            std::swap(this->relaxed_erase, other.relaxed_erase);
+            this->pending.swap(other.pending);
+            this->incoming.swap(other.incoming);
+        }
+
+        const_iterator begin() const {
+            if (sz == 0) {
+                return Iterator(this);
+            }
+            return Iterator(this, left_leaf, 0);
+        }
+
+        const_iterator end() const {
+            return Iterator(this);
+        }
+
+        // calls f(first, last) for the keys of one leaf after the other, ascending, so that whole key arrays can be
+        // processed at once instead of key by key; the next leaf is prefetched while f runs
+        template<typename F>
+        void for_each_leaf(F f) const {
+            for_each_leaf(begin(), end(), f);
+        }
+
+        // the same for the keys in [first, last), the leaves at both ends are passed on in part
+        template<typename F>
+        void for_each_leaf(const const_iterator first, const const_iterator last, F f) const {
+            for (const ExternalNode *leaf {first.current_node}; leaf != nullptr; leaf = leaf->right_neighbour) {
+                if (leaf->right_neighbour != nullptr) {
+                    prefetch_node(leaf->right_neighbour);
+                }
+                const size_type from {leaf == first.current_node ? first.current_element : 0};
+                const size_type to {leaf == last.current_node ? last.current_element : leaf->node_size};
+                if (from < to) {
+                    f(static_cast<const key_type *>(leaf->values + from), static_cast<const key_type *>(leaf->values + to));
+                }
+                if (leaf == last.current_node) {
+                    return;
+                }
+            }
+        }
+
+        const_reverse_iterator rbegin() const {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const {
+            return const_reverse_iterator(begin());
+        }
+
+        // walks the tree level by level, linear in the number of nodes
+        Stats stats() const {
+            Stats result {};
+            result.size = sz;
+            size_type leaves {0};
+            if (root != nullptr) {
+                std::vector<const Node *> level {root};
+                while (!level.empty()) {
+                    result.nodes_per_level.push_back(level.size());
+                    if (level[0]->is_leaf()) {
+                        leaves = level.size();
+                        break;
+                    }
+                    std::vector<const Node *> below;
+                    for (const Node *node: level) {
+                        const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                        below.insert(below.end(), internal->children, internal->children + internal->node_size + 1);
+                    }
+                    level = std::move(below);
+                }
+            }
+            result.height = result.nodes_per_level.size();
+            result.leaf_fill = leaves == 0 ? 0.0 : static_cast<double>(sz) / static_cast<double>(leaves * Node::max_size);
+            result.bytes = leaves * sizeof(ExternalNode) + (std::accumulate(result.nodes_per_level.begin(), result.nodes_per_level.end(), size_type {0}) - leaves) * sizeof(InternalNode);
+#if ADS_SET_STATS
+            result.splits = counters.splits.load(std::memory_order_relaxed);
+            result.merges = counters.merges.load(std::memory_order_relaxed);
+            result.borrows = counters.borrows.load(std::memory_order_relaxed);
+            result.lookups = counters.lookups.load(std::memory_order_relaxed);
+            result.comparisons = counters.comparisons.load(std::memory_order_relaxed);
+#endif
+            return result;
+        }
+
+        // stops or resumes the ADS_SET_STATS counting of this set; not while other threads use it
+        void set_stats(const bool on) {
+#if ADS_SET_STATS
+            counters.counting = on;
+#else
+            static_cast<void>(on);
+#endif
+        }
+
+        // sets the ADS_SET_STATS counters back to zero
+        void reset_stats() {
+#if ADS_SET_STATS
+            counters.splits = 0;
+            counters.merges = 0;
+            counters.borrows = 0;
+            counters.lookups = 0;
+            counters.comparisons = 0;
+#endif
+        }
+
+        void dump(std::ostream &o = std::cerr, size_t n = 0) const {
+            o << "Size: " << sz << std::endl;
+            if (root == nullptr) {
+                o << "Root -" << std::endl;
+                return;
+            }
+            o << "Root ";
+            Node::dump(root, o, n);
+            o << std::endl << "Left ";
+            left_leaf->dump(o, 0);
+        }
+
+        bool operator==(const ADS_set &rhs) const {
+            if (this->sz != rhs.sz) {
+                return false;
+            }
+            auto lit {this->begin()};
+            auto rit {rhs.begin()};
+            while (lit != this->end()) {
+                if (!key_equal {}(*lit, *rit)) {
+                    return false;
+                }
+                ++lit;
+                ++rit;
+            }
+            return true;
+        }
+
+        bool operator!=(const ADS_set &rhs) const {
+            return !(*this == rhs);
+        }
+};
+
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::Iterator {
+    public:
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using reference = const value_type &;
+        using pointer = const value_type *;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+    private:
+        friend class ADS_set;
+        // the set is only needed to step back from end() into its right_leaf
+        const ADS_set *tree;
+        const ExternalNode *current_node;
+        size_type current_element;
+
+    public:
+        Iterator(): tree {nullptr}, current_node {nullptr}, current_element {0} {}
+
+        explicit Iterator(const ADS_set *owner): tree {owner}, current_node {nullptr}, current_element {0} {}
+
+        Iterator(const ADS_set *owner, const ExternalNode *node, const size_type element): tree {owner}, current_node {node}, current_element {element} {}
+
+        reference operator*() const {
+            return current_node->values[current_element];
+        }
+
+        pointer operator->() const {
+            return &current_node->values[current_element];
+        }
+
+        // stepping into a leaf prefetches the one after it, so a scan finds the next leaf in cache
+        Iterator &operator++() {
+            if (current_node == nullptr) {
+                return *this;
+            }
+            if (++current_element >= current_node->node_size) {
+                current_node = current_node->right_neighbour;
+                current_element = 0;
+                if (current_node != nullptr && current_node->right_neighbour != nullptr) {
+                    prefetch_node(current_node->right_neighbour);
+                }
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator copy {*this};
+            ++*this;
+            return copy;
+        }
+
+        Iterator &operator--() {
+            if (current_node == nullptr) {
+                if (tree != nullptr && tree->sz > 0) {
+                    current_node = tree->right_leaf;
+                    current_element = current_node->node_size - 1;
+                }
+                return *this;
+            }
+            if (current_element > 0) {
+                --current_element;
+                return *this;
+            }
+            current_node = current_node->left_neighbour;
+            current_element = current_node == nullptr ? 0 : current_node->node_size - 1;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator copy {*this};
+            --*this;
+            return copy;
+        }
+
+        bool operator==(const Iterator &rhs) const {
+            return this->current_node == rhs.current_node && this->current_element == rhs.current_element;
+        }
+
+        bool operator!=(const Iterator &rhs) const {
+            return this->current_node != rhs.current_node || this->current_element != rhs.current_element;
+        }
+};
+
+// half-open range of a set as handed out by ADS_set::range(); usable in range-based for loops
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::Range {
+    private:
+        Iterator first;
+        Iterator last;
+
+    public:
+        Range(const Iterator from, const Iterator to): first {from}, last {to} {}
+
+        Iterator begin() const {
+            return first;
+        }
+
+        Iterator end() const {
+            return last;
+        }
+
+        bool empty() const {
+            return first == last;
+        }
+};
+
+// read-only view handed out by ADS_set::snapshot(); copies share the nodes as well. the leaf chain and the parent links
+// belong to the live set, so iteration keeps the internal nodes above the current leaf on a stack instead.
+// with ADS_pool_allocator a snapshot has to be destroyed on the thread that modifies the set
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::Snapshot {
+    private:
+        friend class ADS_set;
+        // never modified, it only holds the reference to the shared root
+        ADS_set frozen;
+
+        explicit Snapshot(const ADS_set &set): frozen {set.alloc} {
+            frozen.root = set.root;
+            frozen.sz = set.sz;
+            frozen.shared = true;
+            if (frozen.root != nullptr) {
+                frozen.root->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        Snapshot(const Snapshot &other): Snapshot(other.frozen) {}
+
+        Snapshot(Snapshot &&other) noexcept = default;
+
+        Snapshot &operator=(Snapshot other) noexcept {
+            frozen.swap(other.frozen);
+            return *this;
+        }
+
+        size_type size() const {
+            return frozen.sz;
+        }
+
+        bool empty() const {
+            return frozen.sz == 0;
+        }
+
+        size_type count(const key_type &key) const {
+            return frozen.count(key);
+        }
+
+        template<typename InputIt, typename OutputIt>
+        OutputIt count_many(InputIt first, InputIt last, OutputIt out) const {
+            return frozen.count_many(first, last, out);
+        }
+
+        SnapshotIterator begin() const {
+            SnapshotIterator it;
+            if (frozen.sz > 0) {
+                it.descend(frozen.root);
+            }
+            return it;
+        }
+
+        SnapshotIterator end() const {
+            return SnapshotIterator();
+        }
+
+        // first key not less than key
+        SnapshotIterator lower_bound(const key_type &key) const {
+            SnapshotIterator it;
+            if (frozen.sz == 0) {
+                return it;
+            }
+            const Node *node {frozen.root};
+            while (!node->is_leaf()) {
+                const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                const size_type pos {internal->find_pos(key)};
+                it.path.emplace_back(internal, pos);
+                node = internal->children[pos];
+            }
+            it.leaf = static_cast<const ExternalNode *>(node);
+            it.slot = node->lower_bound(key);
+            it.settle();
+            return it;
+        }
+};
+
+// forward iterator of a Snapshot; the path holds every internal node above the leaf with the index taken in it
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::SnapshotIterator {
+    public:
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using reference = const value_type &;
+        using pointer = const value_type *;
+        using iterator_category = std::forward_iterator_tag;
+
+    private:
+        friend class ADS_set;
+        std::vector<std::pair<const InternalNode *, size_type>> path;
+        const ExternalNode *leaf;
+        size_type slot;
+
+        // down to the leftmost leaf below node
+        void descend(const Node *node) {
+            while (!node->is_leaf()) {
+                const InternalNode *internal {static_cast<const InternalNode *>(node)};
+                path.emplace_back(internal, 0);
+                node = internal->children[0];
+            }
+            leaf = static_cast<const ExternalNode *>(node);
+            slot = 0;
+        }
+
+        // a slot past the end of the leaf moves on to the next leaf, or to end() after the last one
+        void settle() {
+            if (slot < leaf->node_size) {
+                return;
+            }
+            leaf = nullptr;
+            slot = 0;
+            while (!path.empty()) {
+                auto &[node, pos] {path.back()};
+                if (pos < node->node_size) {
+                    const Node *next {node->children[++pos]};
+                    descend(next);
+                    return;
+                }
+                path.pop_back();
+            }
+        }
+
+    public:
+        SnapshotIterator(): leaf {nullptr}, slot {0} {}
+
+        reference operator*() const {
+            return leaf->values[slot];
+        }
+
+        pointer operator->() const {
+            return &leaf->values[slot];
+        }
+
+        SnapshotIterator &operator++() {
+            if (leaf != nullptr) {
+                ++slot;
+                settle();
+            }
+            return *this;
+        }
+
+        SnapshotIterator operator++(int) {
+            SnapshotIterator copy {*this};
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const SnapshotIterator &rhs) const {
+            return this->leaf == rhs.leaf && this->slot == rhs.slot;
+        }
+
+        bool operator!=(const SnapshotIterator &rhs) const {
+            return !(*this == rhs);
+        }
+};
+
+// a saved image opened by ADS_set::open_mapped(). the keys are one sorted array, lookups binary search the sparse index
+// first and then a single page of keys; iterators are plain pointers into the image. move-only
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::Mapped {
+    public:
+        using const_iterator = const key_type *;
+        using iterator = const_iterator;
+
+    private:
+        friend class ADS_set;
+        const std::byte *image;
+        size_type bytes;
+        const key_type *keys;
+        const key_type *index;
+        size_type sz;
+        size_type stride;
+        size_type entries;
+
+        explicit Mapped(const std::string &path);
+
+        // last page of keys whose first key is not greater than key, the result is a page index into keys
+        size_type page_of(const key_type &key) const {
+            const key_type *entry {std::upper_bound(index, index + entries, key, key_compare {})};
+            return entry == index ? 0 : static_cast<size_type>(entry - index) - 1;
+        }
+
+        void unmap() noexcept {
+            if (image == nullptr) {
+                return;
+            }
+#if ADS_SET_MMAP
+            ::munmap(const_cast<std::byte *>(image), bytes);
+#else
+            ::operator delete(const_cast<std::byte *>(image), std::align_val_t {image_page});
+#endif
+            image = nullptr;
+        }
+
+    public:
+        Mapped(Mapped &&other) noexcept
+            : image {std::exchange(other.image, nullptr)}, bytes {other.bytes}, keys {other.keys}, index {other.index}, sz {std::exchange(other.sz, 0)},
+              stride {other.stride}, entries {std::exchange(other.entries, 0)} {}
+
+        Mapped &operator=(Mapped &&other) noexcept {
+            if (this != &other) {
+                unmap();
+                image = std::exchange(other.image, nullptr);
+                bytes = other.bytes;
+                keys = other.keys;
+                index = other.index;
+                sz = std::exchange(other.sz, 0);
+                stride = other.stride;
+                entries = std::exchange(other.entries, 0);
+            }
+            return *this;
+        }
+
+        ~Mapped() {
+            unmap();
+        }
+
+        size_type size() const {
+            return sz;
+        }
+
+        bool empty() const {
+            return sz == 0;
+        }
+
+        const_iterator begin() const {
+            return keys;
+        }
+
+        const_iterator end() const {
+            return keys + sz;
+        }
+
+        const_iterator lower_bound(const key_type &key) const {
+            const size_type page {page_of(key)};
+            return std::lower_bound(keys + page * stride, keys + std::min(sz, (page + 1) * stride), key, key_compare {});
+        }
+
+        const_iterator upper_bound(const key_type &key) const {
+            const size_type page {page_of(key)};
+            return std::upper_bound(keys + page * stride, keys + std::min(sz, (page + 1) * stride), key, key_compare {});
+        }
+
+        const_iterator find(const key_type &key) const {
+            const const_iterator pos {lower_bound(key)};
+            return pos != end() && !key_compare {}(key, *pos) ? pos : end();
+        }
+
+        size_type count(const key_type &key) const {
+            return find(key) != end() ? 1 : 0;
+        }
+};
+
+// maps the whole file and checks the header against key_type before any key is read
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+ADS_set<Key, N, Allocator, Ranked, Compare>::Mapped::Mapped(const std::string &path)
+    : image {nullptr}, bytes {0}, keys {nullptr}, index {nullptr}, sz {0}, stride {1}, entries {0} {
+#if ADS_SET_MMAP
+    const int fd {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd == -1) {
+        throw std::system_error(errno, std::generic_category(), "ADS_set::open_mapped cannot open " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) == -1) {
+        const int error {errno};
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "ADS_set::open_mapped cannot stat " + path);
+    }
+    bytes = static_cast<size_type>(info.st_size);
+    if (bytes < sizeof(ImageHeader)) {
+        ::close(fd);
+        throw std::runtime_error("ADS_set::open_mapped: " + path + " is not an ADS_set image");
+    }
+    // the mapping keeps the file alive, the descriptor is not needed any more
+    void *mapping {::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0)};
+    const int error {errno};
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "ADS_set::open_mapped cannot map " + path);
+    }
+    image = static_cast<const std::byte *>(mapping);
+#else
+    std::ifstream file {path, std::ios::binary | std::ios::ate};
+    if (!file) {
+        throw std::system_error(errno, std::generic_category(), "ADS_set::open_mapped cannot open " + path);
+    }
+    bytes = static_cast<size_type>(file.tellg());
+    if (bytes < sizeof(ImageHeader)) {
+        throw std::runtime_error("ADS_set::open_mapped: " + path + " is not an ADS_set image");
+    }
+    std::byte *buffer {static_cast<std::byte *>(::operator new(bytes, std::align_val_t {image_page}))};
+    image = buffer;
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(bytes))) {
+        unmap();
+        throw std::runtime_error("ADS_set::open_mapped could not read " + path);
+    }
+#endif
+
+    ImageHeader header;
+    std::memcpy(&header, image, sizeof(header));
+    const bool valid {std::memcmp(header.magic, image_magic, sizeof(header.magic)) == 0 && header.version == image_version
+                      && header.byte_order == image_byte_order && header.key_size == sizeof(key_type) && header.key_align == alignof(key_type)
+                      && header.index_stride > 0 && header.keys_offset % alignof(key_type) == 0 && header.index_offset % alignof(key_type) == 0
+                      && header.size <= (bytes - std::min<std::uint64_t>(bytes, header.keys_offset)) / sizeof(key_type)
+                      && header.index_entries == (header.size + header.index_stride - 1) / header.index_stride
+                      && header.index_entries <= (bytes - std::min<std::uint64_t>(bytes, header.index_offset)) / sizeof(key_type)};
+    if (!valid) {
+        unmap();
+        throw std::runtime_error("ADS_set::open_mapped: " + path + " is not an image of this key type");
+    }
+    keys = reinterpret_cast<const key_type *>(image + header.keys_offset);
+    index = reinterpret_cast<const key_type *>(image + header.index_offset);
+    sz = static_cast<size_type>(header.size);
+    stride = static_cast<size_type>(header.index_stride);
+    entries = static_cast<size_type>(header.index_entries);
+}
+
+// string keys packed by ADS_set::pack(). blocks follow the leaves of the set; a lookup finds the block by its first key,
+// compares the prefix of the block once and then binary searches the suffixes only. keys are rebuilt on dereference,
+// PackedIterator::prefix() and suffix() give the two parts as views without copying
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::Packed {
+    public:
+        using const_iterator = PackedIterator;
+        using iterator = const_iterator;
+        using view_type = std::basic_string_view<typename key_type::value_type, typename key_type::traits_type>;
+
+    private:
+        friend class ADS_set;
+        friend class PackedIterator;
+
+        // bytes is where the prefix starts in chars, the suffix of the first key follows it directly
+        struct Block {
+                size_type bytes;
+                size_type prefix;
+                size_type first;
+        };
+
+        std::basic_string<typename key_type::value_type, typename key_type::traits_type> chars;
+        // one block per leaf plus a sentinel with first == size() and bytes == chars.size()
+        std::vector<Block> blocks;
+        // ends[i] is the offset in chars one past the suffix of key i
+        std::vector<size_type> ends;
+
+        explicit Packed(const ADS_set &set) {
+            blocks.reserve(set.sz / Node::max_size + 2);
+            ends.reserve(set.sz);
+            for (const ExternalNode *leaf {set.sz == 0 ? nullptr : set.left_leaf}; leaf != nullptr; leaf = leaf->right_neighbour) {
+                const view_type first {leaf->values[0]};
+                const view_type last {leaf->values[leaf->node_size - 1]};
+                // sorted keys: what the smallest and largest key share is shared by all of them
+                const size_type prefix {static_cast<size_type>(
+                    std::mismatch(first.begin(), first.begin() + std::min(first.size(), last.size()), last.begin()).first - first.begin())};
+                blocks.push_back(Block {chars.size(), prefix, ends.size()});
+                chars.append(first.substr(0, prefix));
+                for (size_type slot {0}; slot < leaf->node_size; ++slot) {
+                    chars.append(view_type {leaf->values[slot]}.substr(prefix));
+                    ends.push_back(chars.size());
+                }
+            }
+            blocks.push_back(Block {chars.size(), 0, ends.size()});
+            chars.shrink_to_fit();
+        }
+
+        view_type prefix_of(const size_type block) const {
+            return view_type {chars}.substr(blocks[block].bytes, blocks[block].prefix);
+        }
+
+        view_type suffix_of(const size_type block, const size_type i) const {
+            const size_type begin {i == blocks[block].first ? blocks[block].bytes + blocks[block].prefix : ends[i - 1]};
+            return view_type {chars}.substr(begin, ends[i] - begin);
+        }
+
+        // three-way comparison of key i of block against key
+        int compare(const size_type block, const size_type i, const view_type key) const {
+            const view_type prefix {prefix_of(block)};
+            // a key shorter than the prefix but matching it compares less, as the prefix is longer
+            if (const int order {prefix.compare(key.substr(0, prefix.size()))}; order != 0) {
+                return order;
+            }
+            return suffix_of(block, i).compare(key.substr(prefix.size()));
+        }
+
+        // first key at or above key (or above it when past_equal is set), as block and index
+        std::pair<size_type, size_type> search(const view_type key, const bool past_equal) const {
+            const size_type count {blocks.size() - 1};
+            if (count == 0) {
+                return {0, 0};
+            }
+            // last block whose first key is not greater than key, block 0 if there is none
+            size_type low {0};
+            size_type high {count};
+            while (high - low > 1) {
+                const size_type mid {low + (high - low) / 2};
+                (compare(mid, blocks[mid].first, key) <= 0 ? low : high) = mid;
+            }
+            const size_type block {low};
+            const view_type prefix {prefix_of(block)};
+            const int order {prefix.compare(key.substr(0, prefix.size()))};
+            size_type lo {blocks[block].first};
+            size_type hi {blocks[block + 1].first};
+            if (order > 0) {
+                hi = lo;
+            } else if (order < 0) {
+                lo = hi;
+            } else {
+                const view_type rest {key.substr(prefix.size())};
+                while (lo < hi) {
+                    const size_type mid {lo + (hi - lo) / 2};
+                    const int c {suffix_of(block, mid).compare(rest)};
+                    (c < 0 || (past_equal && c == 0) ? lo = mid + 1 : hi = mid);
+                }
+            }
+            return lo == blocks[block + 1].first ? std::pair<size_type, size_type> {block + 1, lo} : std::pair<size_type, size_type> {block, lo};
+        }
+
+    public:
+        size_type size() const {
+            return ends.size();
+        }
+
+        bool empty() const {
+            return ends.empty();
+        }
+
+        // bytes held by the packed keys, block table and offsets
+        size_type memory() const {
+            return chars.capacity() * sizeof(typename key_type::value_type) + blocks.capacity() * sizeof(Block) + ends.capacity() * sizeof(size_type);
+        }
+
+        const_iterator begin() const {
+            return PackedIterator(this, 0, 0);
+        }
+
+        const_iterator end() const {
+            return PackedIterator(this, blocks.size() - 1, ends.size());
+        }
+
+        const_iterator lower_bound(const view_type key) const {
+            const auto [block, i] {search(key, false)};
+            return PackedIterator(this, block, i);
+        }
+
+        const_iterator upper_bound(const view_type key) const {
+            const auto [block, i] {search(key, true)};
+            return PackedIterator(this, block, i);
+        }
+
+        const_iterator find(const view_type key) const {
+            const auto [block, i] {search(key, false)};
+            return i < ends.size() && compare(block, i, key) == 0 ? PackedIterator(this, block, i) : end();
+        }
+
+        size_type count(const view_type key) const {
+            return find(key) != end() ? 1 : 0;
+        }
+};
+
+// input iterator over a Packed set, dereferencing rebuilds the key
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+class ADS_set<Key, N, Allocator, Ranked, Compare>::PackedIterator {
+    public:
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type;
+        using pointer = void;
+        using iterator_category = std::input_iterator_tag;
+        using view_type = typename Packed::view_type;
+
+    private:
+        friend class Packed;
+        const Packed *packed;
+        size_type block;
+        size_type i;
+
+        PackedIterator(const Packed *owner, const size_type at_block, const size_type at): packed {owner}, block {at_block}, i {at} {}
+
+    public:
+        PackedIterator(): packed {nullptr}, block {0}, i {0} {}
+
+        view_type prefix() const {
+            return packed->prefix_of(block);
+        }
+
+        view_type suffix() const {
+            return packed->suffix_of(block, i);
+        }
+
+        reference operator*() const {
+            value_type key(prefix());
+            key.append(suffix());
+            return key;
+        }
+
+        PackedIterator &operator++() {
+            if (++i == packed->blocks[block + 1].first) {
+                ++block;
+            }
+            return *this;
+        }
+
+        PackedIterator operator++(int) {
+            PackedIterator copy {*this};
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const PackedIterator &rhs) const {
+            return this->i == rhs.i;
+        }
+
+        bool operator!=(const PackedIterator &rhs) const {
+            return !(*this == rhs);
+        }
+};
+
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare>
+void swap(ADS_set<Key, N, Allocator, Ranked, Compare> &lhs, ADS_set<Key, N, Allocator, Ranked, Compare> &rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+template<typename Key, size_t N, typename Allocator, bool Ranked, typename Compare, typename Pred>
+typename ADS_set<Key, N, Allocator, Ranked, Compare>::size_type erase_if(ADS_set<Key, N, Allocator, Ranked, Compare> &set, Pred pred) {
+    return set.erase_if(pred);
+}
+
+// reader-writer lock for read-mostly data. a reader announces itself in one of Slots counters that sit on cache lines
+// of their own, so readers on different cores never write to a shared line. a writer blocks new readers and waits for
+// every counter to drain, writing is the expensive side
+template<size_t Slots = 64>
+class ADS_read_mostly_lock {
+    private:
+        struct alignas(64) Slot {
+                std::atomic<size_t> readers {0};
+        };
+
+        Slot slots[Slots];
+        alignas(64) std::atomic<bool> writing {false};
+        std::mutex writers;
+
+        // threads are spread over the slots round robin, a thread keeps its slot
+        static Slot &own_slot(Slot *slots) {
+            static std::atomic<size_t> next {0};
+            thread_local const size_t index {next.fetch_add(1, std::memory_order_relaxed) % Slots};
+            return slots[index];
+        }
+
+    public:
+        ADS_read_mostly_lock() = default;
+        ADS_read_mostly_lock(const ADS_read_mostly_lock &) = delete;
+        ADS_read_mostly_lock &operator=(const ADS_read_mostly_lock &) = delete;
+
+        // announcing first and checking for a writer second (both sequentially consistent) pairs with lock()
+        void lock_shared() {
+            Slot &slot {own_slot(slots)};
+            while (true) {
+                slot.readers.fetch_add(1);
+                if (!writing.load()) {
+                    return;
+                }
+                slot.readers.fetch_sub(1);
+                while (writing.load(std::memory_order_relaxed)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void unlock_shared() {
+            own_slot(slots).readers.fetch_sub(1, std::memory_order_release);
+        }
+
+        void lock() {
+            writers.lock();
+            writing.store(true);
+            for (Slot &slot: slots) {
+                while (slot.readers.load() != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        void unlock() {
+            writing.store(false, std::memory_order_release);
+            writers.unlock();
+        }
+};
+
+// ADS_set shared between threads where lookups dominate. lookups run in parallel under the shared side of an
+// ADS_read_mostly_lock and only touch the node memory they read, every modification takes the whole set exclusively.
+// the set does not count for stats(), the ADS_SET_STATS counters would be written by every lookup
+template<typename Key, size_t N = 3, typename Allocator = std::allocator<Key>, bool Ranked = false, typename Compare = std::less<Key>>
+class ADS_concurrent_set {
+    public:
+        using set_type = ADS_set<Key, N, Allocator, Ranked, Compare>;
+        using key_type = typename set_type::key_type;
+        using size_type = typename set_type::size_type;
+
+    private:
+        mutable ADS_read_mostly_lock<> lock;
+        set_type set;
+
+    public:
+        ADS_concurrent_set() {
+            set.set_stats(false);
+        }
+
+        explicit ADS_concurrent_set(set_type initial): set {std::move(initial)} {
+            set.flush();
+            set.set_stats(false);
+        }
+
+        ADS_concurrent_set(const ADS_concurrent_set &) = delete;
+        ADS_concurrent_set &operator=(const ADS_concurrent_set &) = delete;
+
+        size_type size() const {
+            std::shared_lock<ADS_read_mostly_lock<>> guard {lock};
+            return set.size();
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        size_type count(const key_type &key) const {
+            std::shared_lock<ADS_read_mostly_lock<>> guard {lock};
+            return set.count(key);
+        }
+
+        template<typename InputIt, typename OutputIt>
+        OutputIt count_many(InputIt first, InputIt last, OutputIt out) const {
+            std::shared_lock<ADS_read_mostly_lock<>> guard {lock};
+            return set.count_many(first, last, out);
+        }
+
+        bool insert(const key_type &key) {
+            std::lock_guard<ADS_read_mostly_lock<>> guard {lock};
+            return set.insert(key).second;
+        }
+
+        size_type erase(const key_type &key) {
+            std::lock_guard<ADS_read_mostly_lock<>> guard {lock};
+            return set.erase(key);
+        }
+
+        // calls f with the set under the shared lock; iterators must not outlive the call. f sees the set only through
+        // const members, which never change it: write() leaves no buffered keys behind, so there is nothing to flush
+        template<typename F>
+        decltype(auto) read(F &&f) const {
+            std::shared_lock<ADS_read_mostly_lock<>> guard {lock};
+            return std::forward<F>(f)(std::as_const(set));
+        }
+
+        // calls f with the set under the exclusive lock. keys f buffers go into the tree before the lock is released,
+        // so readers never see a buffer
+        template<typename F>
+        decltype(auto) write(F &&f) {
+            std::lock_guard<ADS_read_mostly_lock<>> guard {lock};
+            if constexpr (std::is_void_v<std::invoke_result_t<F, set_type &>>) {
+                std::forward<F>(f)(set);
+                set.flush();
+            } else {
+                decltype(auto) result = std::forward<F>(f)(set);
+                set.flush();
+                return result;
+            }
+        }
+};
+
+#endif // ADS_set
@@ -0,0 +1,299 @@
+// ADS_set against std::set and absl::btree_set over int, uint64_t and std::string keys
+//
+//   cmake -S bench -B build/bench && cmake --build build/bench
+//   build/bench/ads_set_bench --benchmark_out=results.json --benchmark_out_format=json
+//
+// benchmarks are named container/operation/keys, --benchmark_filter picks any of them. besides the run time every
+// benchmark reports time_per_op, the resident bytes the set took when it was built (set_rss_bytes) and the peak RSS
+// of the process up to then (peak_rss_bytes). where the benchmark library has perf counter support,
+// --benchmark_perf_counters=CACHE-MISSES adds the cache misses per iteration
+
+#include "ADS_set.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#if ADS_BENCH_ABSL
+#include <absl/container/btree_set.h>
+#endif
+
+namespace {
+
+    // lookups and scans probe at most this many keys per iteration, so that large sets do not make iterations endless
+    constexpr std::size_t max_probes {std::size_t {1} << 20};
+
+    // keys that sort like i does
+    template<typename Key>
+    Key make_key(const std::uint64_t i) {
+        return static_cast<Key>(i);
+    }
+
+    // longer than the small string buffer, like most real string keys
+    template<>
+    std::string make_key<std::string>(const std::uint64_t i) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "key:%016llx", static_cast<unsigned long long>(i));
+        return buffer;
+    }
+
+    // the sets hold the even keys 0, 2, ..., 2n - 2; odd keys miss. shuffled with a fixed seed
+    template<typename Key>
+    std::vector<Key> make_keys(const std::size_t n, const bool shuffled, const bool odd = false) {
+        std::vector<Key> keys;
+        keys.reserve(n);
+        for (std::uint64_t i {0}; i < n; ++i) {
+            keys.push_back(make_key<Key>(2 * i + (odd ? 1 : 0)));
+        }
+        if (shuffled) {
+            std::shuffle(keys.begin(), keys.end(), std::mt19937_64 {n});
+        }
+        return keys;
+    }
+
+    std::size_t resident_bytes() {
+#if defined(__linux__)
+        std::ifstream statm {"/proc/self/statm"};
+        std::size_t pages {0};
+        std::size_t resident {0};
+        statm >> pages >> resident;
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif
+    }
+
+    std::size_t peak_rss_bytes() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    void report(benchmark::State &state, const std::size_t ops, const std::size_t set_bytes) {
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * ops));
+        state.counters["time_per_op"] = benchmark::Counter(static_cast<double>(ops), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+        state.counters["set_rss_bytes"] = static_cast<double>(set_bytes);
+        state.counters["peak_rss_bytes"] = static_cast<double>(peak_rss_bytes());
+    }
+
+    // a set of the even keys, built key by key in random order like a long running set would be
+    template<typename Set>
+    std::unique_ptr<Set> build(const std::size_t n, std::size_t &set_bytes) {
+        const std::vector<typename Set::key_type> keys {make_keys<typename Set::key_type>(n, true)};
+        const std::size_t before {resident_bytes()};
+        auto set {std::make_unique<Set>()};
+        for (const auto &key: keys) {
+            set->insert(key);
+        }
+        set_bytes = resident_bytes() - std::min(before, resident_bytes());
+        return set;
+    }
+
+    template<typename Set>
+    void insert_keys(benchmark::State &state, const bool shuffled) {
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        const std::vector<typename Set::key_type> keys {make_keys<typename Set::key_type>(n, shuffled)};
+        std::size_t set_bytes {0};
+        for (auto _: state) {
+            state.PauseTiming();
+            const std::size_t before {resident_bytes()};
+            state.ResumeTiming();
+            auto set {std::make_unique<Set>()};
+            for (const auto &key: keys) {
+                set->insert(key);
+            }
+            benchmark::ClobberMemory();
+            state.PauseTiming();
+            set_bytes = resident_bytes() - std::min(before, resident_bytes());
+            set.reset();
+            state.ResumeTiming();
+        }
+        report(state, n, set_bytes);
+    }
+
+    template<typename Set>
+    void insert_random(benchmark::State &state) {
+        insert_keys<Set>(state, true);
+    }
+
+    template<typename Set>
+    void insert_sequential(benchmark::State &state) {
+        insert_keys<Set>(state, false);
+    }
+
+    template<typename Set>
+    void lookup(benchmark::State &state, const bool hit) {
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        std::size_t set_bytes {0};
+        const auto set {build<Set>(n, set_bytes)};
+        std::vector<typename Set::key_type> probes {make_keys<typename Set::key_type>(n, true, !hit)};
+        probes.resize(std::min(n, max_probes));
+        for (auto _: state) {
+            std::size_t found {0};
+            for (const auto &probe: probes) {
+                found += set->count(probe);
+            }
+            benchmark::DoNotOptimize(found);
+        }
+        report(state, probes.size(), set_bytes);
+    }
+
+    template<typename Set>
+    void find_hit(benchmark::State &state) {
+        lookup<Set>(state, true);
+    }
+
+    template<typename Set>
+    void find_miss(benchmark::State &state) {
+        lookup<Set>(state, false);
+    }
+
+    template<typename Set>
+    void iterate(benchmark::State &state) {
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        std::size_t set_bytes {0};
+        const auto set {build<Set>(n, set_bytes)};
+        for (auto _: state) {
+            for (const auto &key: *set) {
+                benchmark::DoNotOptimize(key);
+            }
+        }
+        report(state, n, set_bytes);
+    }
+
+    // lower_bound of a random key, then the 64 keys from there on
+    template<typename Set>
+    void range_scan(benchmark::State &state) {
+        constexpr std::size_t scan {64};
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        std::size_t set_bytes {0};
+        const auto set {build<Set>(n, set_bytes)};
+        std::vector<typename Set::key_type> starts {make_keys<typename Set::key_type>(n, true, true)};
+        starts.resize(std::min(n, max_probes / scan));
+        for (auto _: state) {
+            for (const auto &start: starts) {
+                auto it {set->lower_bound(start)};
+                for (std::size_t i {0}; i < scan && it != set->end(); ++i, ++it) {
+                    benchmark::DoNotOptimize(*it);
+                }
+            }
+        }
+        report(state, starts.size(), set_bytes);
+    }
+
+    // every op erases one key and inserts another, the set keeps its size; iterations swap even and odd keys back and forth
+    template<typename Set>
+    void erase_churn(benchmark::State &state) {
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        std::size_t set_bytes {0};
+        const auto set {build<Set>(n, set_bytes)};
+        std::vector<typename Set::key_type> present {make_keys<typename Set::key_type>(n, true)};
+        std::vector<typename Set::key_type> absent {make_keys<typename Set::key_type>(n, true, true)};
+        present.resize(std::min(n, max_probes));
+        absent.resize(present.size());
+        for (auto _: state) {
+            for (std::size_t i {0}; i < present.size(); ++i) {
+                set->erase(present[i]);
+                set->insert(absent[i]);
+            }
+            present.swap(absent);
+        }
+        report(state, 2 * present.size(), set_bytes);
+    }
+
+    template<typename Set>
+    void copy(benchmark::State &state) {
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        std::size_t set_bytes {0};
+        const auto set {build<Set>(n, set_bytes)};
+        for (auto _: state) {
+            auto copied {std::make_unique<Set>(*set)};
+            benchmark::DoNotOptimize(copied.get());
+            state.PauseTiming();
+            copied.reset();
+            state.ResumeTiming();
+        }
+        report(state, n, set_bytes);
+    }
+
+    template<typename Set>
+    void clear(benchmark::State &state) {
+        const std::size_t n {static_cast<std::size_t>(state.range(0))};
+        std::size_t set_bytes {0};
+        const auto set {build<Set>(n, set_bytes)};
+        for (auto _: state) {
+            state.PauseTiming();
+            auto copied {std::make_unique<Set>(*set)};
+            state.ResumeTiming();
+            copied->clear();
+            benchmark::ClobberMemory();
+        }
+        report(state, n, set_bytes);
+    }
+
+    template<typename Set>
+    void register_set(const std::string &name) {
+        const auto add {[&name](const char *operation, void (*run)(benchmark::State &)) {
+            benchmark::RegisterBenchmark((name + "/" + operation).c_str(), run)
+                ->RangeMultiplier(32)
+                ->Range(1 << 10, ADS_BENCH_MAX_KEYS)
+                ->Unit(benchmark::kMillisecond);
+        }};
+        add("insert_random", insert_random<Set>);
+        add("insert_sequential", insert_sequential<Set>);
+        add("find_hit", find_hit<Set>);
+        add("find_miss", find_miss<Set>);
+        add("iterate", iterate<Set>);
+        add("range_scan", range_scan<Set>);
+        add("erase_churn", erase_churn<Set>);
+        add("copy", copy<Set>);
+        add("clear", clear<Set>);
+    }
+
+    template<typename Key>
+    void register_key(const std::string &key) {
+        register_set<std::set<Key>>("std::set<" + key + ">");
+#if ADS_BENCH_ABSL
+        register_set<absl::btree_set<Key>>("absl::btree_set<" + key + ">");
+#endif
+        register_set<ADS_set<Key, 4>>("ADS_set<" + key + ",4>");
+        register_set<ADS_set<Key, 16>>("ADS_set<" + key + ",16>");
+        register_set<ADS_set<Key, 64>>("ADS_set<" + key + ",64>");
+        register_set<ADS_set<Key, 16, ADS_pool_allocator<Key>>>("ADS_set<" + key + ",16,pool>");
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    register_key<int>("int");
+    register_key<std::uint64_t>("uint64_t");
+    register_key<std::string>("string");
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,59 @@
+// helpers for the ADS_set tests: every set is checked against a std::set that went through the same operations
+//
+//   cmake -S tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+//
+// the tests build with AddressSanitizer and UBSan unless ADS_SET_SANITIZE is OFF
+#pragma once
+
+#include "ADS_set.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace ads_set_test {
+
+    // set holds the keys of expected in the same order and says so in size()
+    template<typename Set, typename Expected>
+    ::testing::AssertionResult same_keys(const Set &set, const Expected &expected) {
+        if (static_cast<std::size_t>(set.size()) != expected.size()) {
+            return ::testing::AssertionFailure() << "size() is " << set.size() << ", expected " << expected.size();
+        }
+        const auto distance {std::distance(set.begin(), set.end())};
+        if (static_cast<std::size_t>(distance) != expected.size()) {
+            return ::testing::AssertionFailure() << "iteration visits " << distance << " keys, expected " << expected.size();
+        }
+        const auto mismatch {std::mismatch(set.begin(), set.end(), expected.begin())};
+        if (mismatch.first != set.end()) {
+            return ::testing::AssertionFailure() << "key " << std::distance(set.begin(), mismatch.first) << " differs";
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+    // n ints drawn from [0, range) in random order, duplicates included
+    inline std::vector<int> random_keys(const std::size_t n, const int range, const unsigned seed) {
+        std::mt19937 rng {seed};
+        std::uniform_int_distribution<int> key {0, range - 1};
+        std::vector<int> keys;
+        keys.reserve(n);
+        for (std::size_t i {0}; i < n; ++i) {
+            keys.push_back(key(rng));
+        }
+        return keys;
+    }
+
+    // 0, 1, ..., n - 1
+    inline std::vector<int> ascending_keys(const std::size_t n) {
+        std::vector<int> keys(n);
+        for (std::size_t i {0}; i < n; ++i) {
+            keys[i] = static_cast<int>(i);
+        }
+        return keys;
+    }
+
+}
@@ -0,0 +1,90 @@
+// the Allocator parameter: every node goes back to the allocator it came from, and ADS_pool_allocator as a drop-in
+
+#include "ads_set_test.h"
+
+#include <memory>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    // std::allocator that counts the objects it has handed out and not got back, in a counter its copies share
+    template<typename T>
+    struct CountingAllocator {
+            using value_type = T;
+
+            std::shared_ptr<long> live;
+
+            CountingAllocator(): live {std::make_shared<long>(0)} {}
+
+            template<typename U>
+            CountingAllocator(const CountingAllocator<U> &other) noexcept: live {other.live} {}
+
+            T *allocate(const std::size_t n) {
+                *live += static_cast<long>(n);
+                return std::allocator<T> {}.allocate(n);
+            }
+
+            void deallocate(T *p, const std::size_t n) noexcept {
+                *live -= static_cast<long>(n);
+                std::allocator<T> {}.deallocate(p, n);
+            }
+
+            template<typename U>
+            bool operator==(const CountingAllocator<U> &rhs) const noexcept {
+                return live == rhs.live;
+            }
+
+            template<typename U>
+            bool operator!=(const CountingAllocator<U> &rhs) const noexcept {
+                return live != rhs.live;
+            }
+    };
+
+}
+
+TEST(Allocator, EveryNodeGoesBack) {
+    const CountingAllocator<int> allocator;
+    {
+        ADS_set<int, 2, CountingAllocator<int>> set {allocator};
+        for (const int key: random_keys(5000, 3000, 11)) {
+            set.insert(key);
+        }
+        EXPECT_GT(*allocator.live, 0);
+        EXPECT_TRUE(set.get_allocator() == allocator);
+        for (int key {0}; key < 3000; key += 2) {
+            set.erase(key);
+        }
+        ADS_set<int, 2, CountingAllocator<int>> copy {set};
+        copy.clear();
+        EXPECT_TRUE(copy.empty());
+    }
+    EXPECT_EQ(*allocator.live, 0);
+}
+
+TEST(Allocator, PoolAllocatorChurn) {
+    using Set = ADS_set<int, 3, ADS_pool_allocator<int>>;
+    Set set;
+    std::set<int> expected;
+    std::mt19937 rng {12};
+    for (int round {0}; round < 20000; ++round) {
+        const int key {static_cast<int>(rng() % 2000)};
+        if (rng() % 3 == 0) {
+            ASSERT_EQ(set.erase(key), expected.erase(key));
+        } else {
+            set.insert(key);
+            expected.insert(key);
+        }
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    // a copy gets a pool of its own
+    Set copy {set};
+    EXPECT_TRUE(copy.get_allocator() != set.get_allocator());
+    set.clear();
+    EXPECT_TRUE(same_keys(copy, expected));
+    Set moved {std::move(copy)};
+    EXPECT_TRUE(same_keys(moved, expected));
+    set = moved;
+    EXPECT_TRUE(same_keys(set, expected));
+}
@@ -0,0 +1,194 @@
+// insert_buffered() and flush(): lookups, size() and save() see buffered keys, iteration only once they are flushed
+
+#include "ads_set_test.h"
+
+#include <string>
+#include <utility>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+TEST(BufferedInsert, FlushMergesEverything) {
+    for (const std::size_t n: {0, 1, 100, 30000}) {
+        const std::vector<int> keys {random_keys(n, static_cast<int>(n) + 1, 27)};
+        ADS_set<int, 3> set {-1, 1000000};
+        std::set<int> expected {-1, 1000000};
+        for (const int key: keys) {
+            set.insert_buffered(key);
+            expected.insert(key);
+            ASSERT_TRUE(set.contains(key));
+        }
+        set.flush();
+        ASSERT_TRUE(same_keys(set, expected)) << n;
+        set.flush();
+        EXPECT_TRUE(same_keys(set, expected));
+    }
+}
+
+TEST(BufferedInsert, LookupsSeeTheBuffer) {
+    ADS_set<int> set {1, 2};
+    set.insert_buffered(3);
+    set.insert_buffered(1);
+    const ADS_set<int> &view {set};
+    EXPECT_EQ(view.count(3), 1u);
+    EXPECT_TRUE(view.contains(3));
+    EXPECT_EQ(view.size(), 3u);
+    EXPECT_FALSE(view.empty());
+    // iteration and the bounds see the tree only, and const members leave the buffer alone
+    EXPECT_EQ(std::distance(view.begin(), view.end()), 2);
+    EXPECT_EQ(view.lower_bound(3), view.end());
+    EXPECT_EQ(view.find(3), view.end());
+    EXPECT_EQ(view.count(3), 1u);
+    // find() on the set flushes first
+    const auto it {set.find(3)};
+    ASSERT_NE(it, set.end());
+    EXPECT_EQ(*it, 3);
+    EXPECT_TRUE(same_keys(set, std::set<int> {1, 2, 3}));
+    ADS_set<int> buffered_only;
+    buffered_only.insert_buffered(5);
+    buffered_only.insert_buffered(5);
+    EXPECT_FALSE(buffered_only.empty());
+    EXPECT_EQ(buffered_only.size(), 1u);
+}
+
+TEST(BufferedInsert, RangeEraseTakesBufferedKeys) {
+    for (const bool to_end: {false, true}) {
+        ADS_set<int, 2> set;
+        std::set<int> expected;
+        for (int key {0}; key < 200; key += 2) {
+            set.insert(key);
+            expected.insert(key);
+        }
+        for (int key {1}; key < 260; key += 2) {
+            set.insert_buffered(key);
+            expected.insert(key);
+        }
+        set.insert_buffered(50);
+        const auto last {to_end ? set.end() : set.lower_bound(150)};
+        set.erase(set.lower_bound(40), last);
+        expected.erase(expected.lower_bound(40), to_end ? expected.end() : expected.lower_bound(150));
+        EXPECT_EQ(set.size(), expected.size());
+        set.flush();
+        EXPECT_TRUE(same_keys(set, expected)) << to_end;
+    }
+    ADS_set<int> set {1};
+    set.insert_buffered(1);
+    set.erase(set.begin(), set.end());
+    EXPECT_TRUE(set.empty());
+    set.flush();
+    EXPECT_TRUE(set.empty());
+    set.insert({2, 3});
+    set.insert_buffered(2);
+    set.erase(set.begin());
+    set.flush();
+    EXPECT_TRUE(same_keys(set, std::set<int> {3}));
+}
+
+TEST(BufferedInsert, SaveWritesBufferedKeys) {
+    ADS_set<int, 3> set;
+    std::set<int> expected;
+    for (int key {0}; key < 5000; key += 2) {
+        set.insert(key);
+        expected.insert(key);
+    }
+    for (int key {0}; key < 7000; key += 3) {
+        set.insert_buffered(key);
+        expected.insert(key);
+    }
+    const std::string path {::testing::TempDir() + "ads_set_buffered.img"};
+    std::as_const(set).save(path);
+    const auto mapped {ADS_set<int, 3>::open_mapped(path)};
+    EXPECT_TRUE(same_keys(mapped, expected));
+    EXPECT_EQ(mapped.count(6999), 1u);
+    EXPECT_EQ(mapped.count(6998), 0u);
+}
+
+TEST(BufferedInsert, EraseTakesKeysOutOfTheBuffer) {
+    ADS_set<std::string> set {"tree"};
+    set.insert_buffered("buffered");
+    set.insert_buffered("tree");
+    EXPECT_EQ(set.erase("buffered"), 1u);
+    EXPECT_EQ(set.count("buffered"), 0u);
+    EXPECT_EQ(set.erase("tree"), 1u);
+    EXPECT_EQ(set.count("tree"), 0u);
+    set.flush();
+    EXPECT_TRUE(set.empty());
+}
+
+TEST(BufferedInsert, ChangingMembersFlushFirst) {
+    std::set<int> expected;
+    ADS_set<int, 2> set;
+    for (int key {0}; key < 100; ++key) {
+        set.insert_buffered(key);
+        expected.insert(key);
+    }
+    set.insert(1000);
+    expected.insert(1000);
+    EXPECT_TRUE(same_keys(set, expected));
+    for (int key {100}; key < 200; ++key) {
+        set.insert_buffered(key);
+        expected.insert(key);
+    }
+    ADS_set<int, 2> upper {set.split_at(150)};
+    EXPECT_EQ(set.size(), 150u);
+    EXPECT_EQ(upper.size(), 51u);
+    set.join(std::move(upper));
+    for (int key {200}; key < 300; ++key) {
+        set.insert_buffered(key);
+        expected.insert(key);
+    }
+    EXPECT_EQ(set.erase_if([](const int key) { return key % 10 == 0; }), 31u);
+    for (auto it {expected.begin()}; it != expected.end();) {
+        it = *it % 10 == 0 ? expected.erase(it) : std::next(it);
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    set.insert_buffered(-5);
+    const auto snapshot {set.snapshot()};
+    expected.insert(-5);
+    EXPECT_TRUE(same_keys(snapshot, expected));
+}
+
+TEST(BufferedInsert, CopiesAndMovesTakeTheBuffer) {
+    ADS_set<int> set {1};
+    set.insert_buffered(2);
+    ADS_set<int> copy {set};
+    EXPECT_EQ(copy.count(2), 1u);
+    ADS_set<int> moved {std::move(set)};
+    EXPECT_EQ(moved.count(2), 1u);
+    copy.flush();
+    moved.flush();
+    EXPECT_TRUE(same_keys(copy, std::set<int> {1, 2}));
+    EXPECT_TRUE(copy == moved);
+    moved.insert_buffered(3);
+    moved.clear();
+    EXPECT_EQ(moved.count(3), 0u);
+}
+
+TEST(BufferedInsert, HintsTakenBeforeBufferedKeys) {
+    // flushing the buffered keys splits the leaf the hint points into
+    ADS_set<std::string, 3> set {"b", "d", "f"};
+    std::set<std::string> expected {"b", "d", "f"};
+    const auto hint {set.find("d")};
+    for (const char *key: {"a", "a1", "a2", "a3", "a4"}) {
+        set.insert_buffered(key);
+        expected.insert(key);
+    }
+    set.insert(hint, "c");
+    expected.insert("c");
+    EXPECT_TRUE(same_keys(set, expected));
+    std::mt19937 rng {28};
+    ADS_set<int, 2> numbers;
+    std::set<int> expected_numbers;
+    for (int round {0}; round < 2000; ++round) {
+        const int key {static_cast<int>(rng() % 5000)};
+        const auto at {numbers.lower_bound(key)};
+        for (int i {0}; i < 4; ++i) {
+            const int buffered {static_cast<int>(rng() % 5000)};
+            numbers.insert_buffered(buffered);
+            expected_numbers.insert(buffered);
+        }
+        numbers.insert(at, key);
+        expected_numbers.insert(key);
+    }
+    EXPECT_TRUE(same_keys(numbers, expected_numbers));
+}
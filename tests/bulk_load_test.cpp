@@ -0,0 +1,69 @@
+// bottom-up bulk loading: the range constructor, insert(first, last) and the sorted_unique overloads
+
+#include "ads_set_test.h"
+
+#include <string>
+
+using ads_set_test::ascending_keys;
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    template<typename Set>
+    void expect_loaded(const std::vector<int> &keys) {
+        const std::set<int> expected(keys.begin(), keys.end());
+        Set set(keys.begin(), keys.end());
+        EXPECT_TRUE(same_keys(set, expected));
+        // the loaded tree takes regular inserts and erases
+        set.insert(-1);
+        set.insert(static_cast<int>(keys.size()) + 1);
+        EXPECT_EQ(set.erase(-1), 1u);
+        for (const int key: expected) {
+            ASSERT_EQ(set.erase(key), 1u);
+        }
+        EXPECT_EQ(set.size(), 1u);
+    }
+
+}
+
+TEST(BulkLoad, AscendingRangeAroundLeafBoundaries) {
+    for (const std::size_t n: {0, 1, 2, 5, 6, 7, 12, 13, 100, 1000, 4097}) {
+        expect_loaded<ADS_set<int, 1>>(ascending_keys(n));
+        expect_loaded<ADS_set<int, 3>>(ascending_keys(n));
+        expect_loaded<ADS_set<int, 16>>(ascending_keys(n));
+    }
+}
+
+TEST(BulkLoad, UnsortedRangeWithDuplicates) {
+    expect_loaded<ADS_set<int>>(random_keys(5000, 2000, 1));
+}
+
+TEST(BulkLoad, RangeInsertIntoFilledSet) {
+    ADS_set<int> set {5, -1, 2000};
+    const std::vector<int> keys {ascending_keys(1000)};
+    set.insert(keys.begin(), keys.end());
+    std::set<int> expected(keys.begin(), keys.end());
+    expected.insert({-1, 2000});
+    EXPECT_TRUE(same_keys(set, expected));
+}
+
+TEST(BulkLoad, SortedUniqueTagWithLeafFill) {
+    const std::vector<int> keys {ascending_keys(1000)};
+    const std::set<int> expected(keys.begin(), keys.end());
+    for (const std::size_t fill: {1, 3, 6}) {
+        ADS_set<int, 3> set(ADS_set<int, 3>::sorted_unique, keys.begin(), keys.end(), fill);
+        EXPECT_TRUE(same_keys(set, expected));
+        EXPECT_EQ(set.count(999), 1u);
+        EXPECT_EQ(set.count(1000), 0u);
+    }
+}
+
+TEST(BulkLoad, StringKeys) {
+    std::vector<std::string> keys;
+    for (int i {0}; i < 500; ++i) {
+        keys.push_back("key" + std::to_string(1000 + i));
+    }
+    ADS_set<std::string, 4> set(keys.begin(), keys.end());
+    EXPECT_TRUE(same_keys(set, std::set<std::string>(keys.begin(), keys.end())));
+}
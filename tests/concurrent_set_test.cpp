@@ -0,0 +1,71 @@
+// ADS_concurrent_set: readers in parallel with a writer, and write() leaving no buffered keys for the readers
+
+#include "ads_set_test.h"
+
+#include <atomic>
+#include <thread>
+
+TEST(ConcurrentSet, ReadersSeeEveryStableKey) {
+    ADS_concurrent_set<int> set;
+    for (int key {0}; key < 20000; key += 2) {
+        set.insert(key);
+    }
+    std::atomic<bool> stop {false};
+    std::atomic<int> misses {0};
+    std::vector<std::thread> readers;
+    for (int t {0}; t < 3; ++t) {
+        readers.emplace_back([&set, &misses, t] {
+            for (int round {0}; round < 20000; ++round) {
+                // the even keys are never touched by the writer
+                const int key {(round * 7 + t) % 10000 * 2};
+                if (set.count(key) != 1) {
+                    ++misses;
+                }
+                if (round % 1000 == 0) {
+                    set.read([&misses](const auto &s) {
+                        if (std::distance(s.begin(), s.end()) < 10000) {
+                            ++misses;
+                        }
+                    });
+                }
+            }
+        });
+    }
+    std::thread writer {[&set, &stop] {
+        for (int key {1}; !stop; key = (key + 2) % 20000) {
+            set.insert(key);
+            set.erase(key);
+            set.write([key](auto &s) { s.insert_buffered(key); });
+            set.erase(key);
+        }
+    }};
+    for (std::thread &reader: readers) {
+        reader.join();
+    }
+    stop = true;
+    writer.join();
+    EXPECT_EQ(misses, 0);
+    EXPECT_EQ(set.size(), 10000u);
+}
+
+TEST(ConcurrentSet, WriteFlushesBufferedKeys) {
+    ADS_concurrent_set<int> set;
+    set.write([](auto &s) {
+        for (int key {0}; key < 100; ++key) {
+            s.insert_buffered(key);
+        }
+    });
+    EXPECT_EQ(set.size(), 100u);
+    EXPECT_EQ(set.read([](const auto &s) { return std::distance(s.begin(), s.end()); }), 100);
+    const ADS_concurrent_set<int> from_set {[] {
+        ADS_set<int> s;
+        s.insert_buffered(1);
+        s.insert_buffered(2);
+        return s;
+    }()};
+    EXPECT_EQ(from_set.size(), 2u);
+    std::vector<std::size_t> counts;
+    const std::vector<int> probes {0, 1, 2, 3};
+    from_set.count_many(probes.begin(), probes.end(), std::back_inserter(counts));
+    EXPECT_EQ(counts, (std::vector<std::size_t> {0, 1, 1, 0}));
+}
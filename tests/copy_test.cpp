@@ -0,0 +1,57 @@
+// structural copy construction and copy assignment
+
+#include "ads_set_test.h"
+
+#include <string>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+TEST(Copy, ConstructedCopyHasTheSameKeys) {
+    for (const std::size_t n: {0, 1, 6, 7, 100, 5000}) {
+        const std::vector<int> keys {random_keys(n, 10000, 2)};
+        const std::set<int> expected(keys.begin(), keys.end());
+        const ADS_set<int, 3> set(keys.begin(), keys.end());
+        const ADS_set<int, 3> copy {set};
+        EXPECT_TRUE(same_keys(copy, expected));
+        EXPECT_TRUE(copy == set);
+    }
+}
+
+TEST(Copy, CopyIsIndependentOfTheOriginal) {
+    const std::vector<int> keys {random_keys(3000, 5000, 3)};
+    const std::set<int> expected(keys.begin(), keys.end());
+    ADS_set<int, 2> set(keys.begin(), keys.end());
+    ADS_set<int, 2> copy {set};
+    for (int key {0}; key < 5000; key += 2) {
+        copy.erase(key);
+    }
+    copy.insert(-7);
+    set.insert(-3);
+    EXPECT_EQ(copy.count(-3), 0u);
+    EXPECT_EQ(set.count(-7), 0u);
+    std::set<int> original {expected};
+    original.insert(-3);
+    EXPECT_TRUE(same_keys(set, original));
+    std::set<int> changed;
+    for (const int key: expected) {
+        if (key % 2 != 0) {
+            changed.insert(key);
+        }
+    }
+    changed.insert(-7);
+    EXPECT_TRUE(same_keys(copy, changed));
+}
+
+TEST(Copy, AssignmentReplacesTheKeys) {
+    const ADS_set<std::string> source {"b", "a", "d", "c"};
+    ADS_set<std::string> target {"x", "y"};
+    target = source;
+    EXPECT_TRUE(same_keys(target, std::set<std::string> {"a", "b", "c", "d"}));
+    const ADS_set<std::string> &same {target};
+    target = same;
+    EXPECT_TRUE(same_keys(target, std::set<std::string> {"a", "b", "c", "d"}));
+    target = ADS_set<std::string> {};
+    EXPECT_TRUE(target.empty());
+    EXPECT_EQ(target.begin(), target.end());
+}
@@ -0,0 +1,76 @@
+// emplace and the move-aware insert paths
+
+#include "ads_set_test.h"
+
+#include <string>
+
+using ads_set_test::same_keys;
+
+namespace {
+
+    // counts its copies; moves are free
+    struct Tracked {
+            static inline int copies {0};
+
+            int value {0};
+
+            Tracked() = default;
+            explicit Tracked(const int v): value {v} {}
+            Tracked(const Tracked &other): value {other.value} {
+                ++copies;
+            }
+            Tracked(Tracked &&other) noexcept = default;
+            Tracked &operator=(const Tracked &other) {
+                value = other.value;
+                ++copies;
+                return *this;
+            }
+            Tracked &operator=(Tracked &&other) noexcept = default;
+
+            bool operator<(const Tracked &rhs) const {
+                return value < rhs.value;
+            }
+    };
+
+}
+
+TEST(Emplace, RvaluesAreNeverCopied) {
+    // separators are copies of leaf keys, so the keys stay in one leaf where nothing splits
+    ADS_set<Tracked, 64> set;
+    Tracked::copies = 0;
+    for (int i {0}; i < 30; ++i) {
+        set.insert(Tracked {i * 7 % 30});
+        set.emplace(30 + i);
+        set.emplace_hint(set.end(), 100 + i);
+        set.insert(set.begin(), Tracked {-1 - i});
+    }
+    for (int i {0}; i < 30; i += 3) {
+        set.erase(Tracked {i});
+    }
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(set.size(), 110u);
+}
+
+TEST(Emplace, HeavyKeysThroughSplits) {
+    ADS_set<std::string, 2> set;
+    std::set<std::string> expected;
+    for (int i {0}; i < 2000; ++i) {
+        std::string key {"a key long enough to live on the heap " + std::to_string(i * 7 % 2000)};
+        expected.insert(key);
+        if (i % 2 == 0) {
+            set.emplace(std::move(key));
+        } else {
+            set.insert(std::move(key));
+        }
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+}
+
+TEST(Emplace, DuplicateRvalueIsNotMovedFrom) {
+    ADS_set<std::string> set {"a long key that owns heap memory"};
+    std::string key {"a long key that owns heap memory"};
+    const auto [it, inserted] {set.insert(std::move(key))};
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(key, "a long key that owns heap memory");
+    EXPECT_EQ(*it, key);
+}
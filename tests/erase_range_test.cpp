@@ -0,0 +1,67 @@
+// erase(pos) and erase(first, last)
+
+#include "ads_set_test.h"
+
+using ads_set_test::ascending_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    // erases [from, to) out of the keys 0 .. n - 1 and compares with std::set::erase
+    template<typename Set>
+    void expect_range_erased(const int n, const int from, const int to) {
+        const std::vector<int> keys {ascending_keys(static_cast<std::size_t>(n))};
+        Set set(keys.begin(), keys.end());
+        std::set<int> expected(keys.begin(), keys.end());
+        const auto next {set.erase(set.lower_bound(from), set.lower_bound(to))};
+        const auto expected_next {expected.erase(expected.lower_bound(from), expected.lower_bound(to))};
+        ASSERT_TRUE(same_keys(set, expected)) << n << " [" << from << ", " << to << ")";
+        ASSERT_EQ(next == set.end() ? -1 : *next, expected_next == expected.end() ? -1 : *expected_next);
+        // the tree is still in shape for inserts and erases
+        for (int key {std::max(from, 0)}; key < std::min(to, n); ++key) {
+            set.insert(key);
+        }
+        ASSERT_EQ(set.size(), static_cast<std::size_t>(n));
+        for (int key {0}; key < n; key += 2) {
+            ASSERT_EQ(set.erase(key), 1u);
+        }
+    }
+
+}
+
+TEST(EraseRange, EveryShapeOfRange) {
+    for (const int n: {0, 1, 10, 100, 2000}) {
+        for (const int from: {0, 1, n / 3, n / 2, n - 1, n}) {
+            for (const int to: {from, from + 1, from + 7, n / 2, n - 1, n}) {
+                if (from <= to) {
+                    expect_range_erased<ADS_set<int, 1>>(n, from, to);
+                    expect_range_erased<ADS_set<int, 3>>(n, from, to);
+                    expect_range_erased<ADS_set<int, 3, std::allocator<int>, true>>(n, from, to);
+                }
+            }
+        }
+    }
+}
+
+TEST(EraseRange, EraseByIterator) {
+    ADS_set<int, 2> set;
+    std::set<int> expected;
+    for (int key {0}; key < 1000; ++key) {
+        set.insert(key);
+        expected.insert(key);
+    }
+    // every third key, walking with the iterator erase returns
+    auto it {set.begin()};
+    int position {0};
+    while (it != set.end()) {
+        if (position++ % 3 == 0) {
+            expected.erase(*it);
+            it = set.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    EXPECT_EQ(set.erase(set.begin(), set.end()), set.end());
+    EXPECT_TRUE(set.empty());
+}
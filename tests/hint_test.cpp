@@ -0,0 +1,57 @@
+// insert with a hint and emplace_hint
+
+#include "ads_set_test.h"
+
+#include <string>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+TEST(Hint, AppendAtEnd) {
+    ADS_set<int, 3> set;
+    std::set<int> expected;
+    for (int key {0}; key < 5000; ++key) {
+        const auto it {set.insert(set.end(), key)};
+        ASSERT_EQ(*it, key);
+        expected.insert(key);
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+}
+
+TEST(Hint, RightBeforeTheHint) {
+    ADS_set<int, 2> set;
+    auto hint {set.end()};
+    for (int key {3000}; key > 0; --key) {
+        hint = set.insert(hint, key);
+        ASSERT_EQ(*hint, key);
+    }
+    std::set<int> expected;
+    for (int key {1}; key <= 3000; ++key) {
+        expected.insert(key);
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+}
+
+TEST(Hint, WrongHintsStillInsertInOrder) {
+    ADS_set<int, 2> set;
+    std::set<int> expected;
+    for (const int key: random_keys(3000, 6000, 6)) {
+        const auto it {set.insert(set.begin(), key)};
+        ASSERT_EQ(*it, key);
+        expected.insert(key);
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    const auto it {set.insert(set.end(), *expected.begin())};
+    EXPECT_EQ(it, set.begin());
+    EXPECT_EQ(set.size(), expected.size());
+}
+
+TEST(Hint, EmplaceHint) {
+    ADS_set<std::string> set;
+    auto hint {set.end()};
+    hint = set.emplace_hint(hint, 3, 'c');
+    hint = set.emplace_hint(hint, 2, 'b');
+    set.emplace_hint(set.end(), "d");
+    EXPECT_EQ(*hint, "bb");
+    EXPECT_TRUE(same_keys(set, std::set<std::string> {"bb", "ccc", "d"}));
+}
@@ -0,0 +1,72 @@
+// keys stored inline in the nodes: keys that own memory survive every move between nodes
+
+#include "ads_set_test.h"
+
+#include <memory>
+#include <string>
+
+using ads_set_test::same_keys;
+
+namespace {
+
+    // longer than any small string buffer, so that every key owns heap memory
+    std::string long_key(const int i) {
+        return "a key that does not fit into a small string buffer #" + std::to_string(i);
+    }
+
+    // orders by the value it owns through a unique_ptr, copies deep
+    struct Boxed {
+            std::unique_ptr<int> value;
+
+            Boxed(): value {std::make_unique<int>(0)} {}
+            explicit Boxed(const int v): value {std::make_unique<int>(v)} {}
+            Boxed(const Boxed &other): value {std::make_unique<int>(*other.value)} {}
+            Boxed(Boxed &&other) noexcept = default;
+            Boxed &operator=(const Boxed &other) {
+                value = std::make_unique<int>(*other.value);
+                return *this;
+            }
+            Boxed &operator=(Boxed &&other) noexcept = default;
+
+            bool operator<(const Boxed &rhs) const {
+                return *value < *rhs.value;
+            }
+            bool operator==(const Boxed &rhs) const {
+                return *value == *rhs.value;
+            }
+    };
+
+}
+
+TEST(InlineKeys, LongStringsThroughSplitsAndMerges) {
+    ADS_set<std::string, 2> set;
+    std::set<std::string> expected;
+    for (int i {0}; i < 2000; ++i) {
+        set.insert(long_key(i * 7 % 2000));
+        expected.insert(long_key(i * 7 % 2000));
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    for (int i {0}; i < 2000; i += 3) {
+        ASSERT_EQ(set.erase(long_key(i)), 1u);
+        expected.erase(long_key(i));
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    const ADS_set<std::string, 2> copy {set};
+    EXPECT_TRUE(same_keys(copy, expected));
+}
+
+TEST(InlineKeys, KeysThatOwnAUniquePtr) {
+    ADS_set<Boxed, 3> set;
+    for (int i {0}; i < 1000; ++i) {
+        set.insert(Boxed {(i * 13) % 1000});
+    }
+    for (int i {0}; i < 1000; i += 2) {
+        ASSERT_EQ(set.erase(Boxed {i}), 1u);
+    }
+    ASSERT_EQ(set.size(), 500u);
+    int expected {1};
+    for (const Boxed &key: set) {
+        ASSERT_EQ(*key.value, expected);
+        expected += 2;
+    }
+}
@@ -0,0 +1,39 @@
+// insert(key) returns the iterator to the key whether it went in or was there already
+
+#include "ads_set_test.h"
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+TEST(Insert, ReturnsTheIteratorToTheKey) {
+    for (const std::size_t n: {1, 10, 3000}) {
+        ADS_set<int, 2> set;
+        std::set<int> expected;
+        for (const int key: random_keys(n, static_cast<int>(n), 5)) {
+            const auto [it, inserted] {set.insert(key)};
+            EXPECT_EQ(inserted, expected.insert(key).second);
+            ASSERT_NE(it, set.end());
+            EXPECT_EQ(*it, key);
+            EXPECT_EQ(it, set.find(key));
+            // the iterator walks on to the next key, also right after a split
+            auto next {it};
+            ++next;
+            const auto expected_next {std::next(expected.find(key))};
+            if (expected_next == expected.end()) {
+                EXPECT_EQ(next, set.end());
+            } else {
+                ASSERT_NE(next, set.end());
+                EXPECT_EQ(*next, *expected_next);
+            }
+        }
+        EXPECT_TRUE(same_keys(set, expected));
+    }
+}
+
+TEST(Insert, DuplicateLeavesTheSetAlone) {
+    ADS_set<int> set {1, 2, 3};
+    const auto [it, inserted] {set.insert(2)};
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(*it, 2);
+    EXPECT_TRUE(same_keys(set, std::set<int> {1, 2, 3}));
+}
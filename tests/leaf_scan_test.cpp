@@ -0,0 +1,48 @@
+// for_each_leaf() and the iteration it shares its leaf walk with
+
+#include "ads_set_test.h"
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    template<typename Set>
+    std::vector<int> scanned(const Set &set, const typename Set::const_iterator first, const typename Set::const_iterator last) {
+        std::vector<int> keys;
+        set.for_each_leaf(first, last, [&keys](const int *from, const int *to) {
+            EXPECT_LT(from, to);
+            keys.insert(keys.end(), from, to);
+        });
+        return keys;
+    }
+
+}
+
+TEST(LeafScan, WholeSet) {
+    for (const std::size_t n: {0, 1, 7, 5000}) {
+        const std::vector<int> keys {random_keys(n, 10000, 28)};
+        const ADS_set<int, 2> set(keys.begin(), keys.end());
+        const std::set<int> expected(keys.begin(), keys.end());
+        std::vector<int> all;
+        set.for_each_leaf([&all](const int *from, const int *to) { all.insert(all.end(), from, to); });
+        EXPECT_EQ(all, std::vector<int>(expected.begin(), expected.end()));
+        EXPECT_TRUE(same_keys(set, expected));
+    }
+}
+
+TEST(LeafScan, PartsOfLeavesAtBothEnds) {
+    ADS_set<int, 3> set;
+    for (int key {0}; key < 1000; ++key) {
+        set.insert(key);
+    }
+    for (const auto &[from, to]: std::vector<std::pair<int, int>> {{0, 1000}, {3, 4}, {5, 5}, {17, 503}, {998, 1000}, {0, 1}}) {
+        const std::vector<int> keys {scanned(set, set.find(from), to == 1000 ? set.end() : set.find(to))};
+        ASSERT_EQ(keys.size(), static_cast<std::size_t>(to - from));
+        for (std::size_t i {0}; i < keys.size(); ++i) {
+            ASSERT_EQ(keys[i], from + static_cast<int>(i));
+        }
+    }
+    const auto range {set.range(100, 200)};
+    EXPECT_EQ(scanned(set, range.begin(), range.end()).size(), 100u);
+}
@@ -0,0 +1,54 @@
+// count_many and find_many over sorted, unsorted and single pass probes
+
+#include "ads_set_test.h"
+
+#include <iterator>
+#include <list>
+#include <sstream>
+
+using ads_set_test::random_keys;
+
+TEST(LookupMany, SortedAndUnsortedProbes) {
+    const std::vector<int> keys {random_keys(4000, 10000, 15)};
+    const ADS_set<int, 3> set(keys.begin(), keys.end());
+    const std::set<int> expected(keys.begin(), keys.end());
+    std::vector<int> probes {random_keys(3000, 10002, 16)};
+    for (const bool sorted: {false, true}) {
+        if (sorted) {
+            std::sort(probes.begin(), probes.end());
+        }
+        std::vector<std::size_t> counts;
+        set.count_many(probes.begin(), probes.end(), std::back_inserter(counts));
+        std::vector<ADS_set<int, 3>::iterator> found;
+        set.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+        ASSERT_EQ(counts.size(), probes.size());
+        ASSERT_EQ(found.size(), probes.size());
+        for (std::size_t i {0}; i < probes.size(); ++i) {
+            ASSERT_EQ(counts[i], expected.count(probes[i]));
+            ASSERT_EQ(found[i], set.find(probes[i]));
+        }
+    }
+}
+
+TEST(LookupMany, SinglePassAndListProbes) {
+    const ADS_set<int> set {1, 3, 5};
+    std::istringstream input {"5 4 3 2 1"};
+    std::vector<std::size_t> counts;
+    set.count_many(std::istream_iterator<int> {input}, std::istream_iterator<int> {}, std::back_inserter(counts));
+    EXPECT_EQ(counts, (std::vector<std::size_t> {1, 0, 1, 0, 1}));
+    const std::list<int> probes {0, 1, 1, 6};
+    counts.clear();
+    set.count_many(probes.begin(), probes.end(), std::back_inserter(counts));
+    EXPECT_EQ(counts, (std::vector<std::size_t> {0, 1, 1, 0}));
+}
+
+TEST(LookupMany, EmptySetAndNoProbes) {
+    const ADS_set<int> set;
+    const std::vector<int> probes {1, 2};
+    std::vector<ADS_set<int>::iterator> found;
+    set.find_many(probes.begin(), probes.end(), std::back_inserter(found));
+    EXPECT_EQ(found, (std::vector<ADS_set<int>::iterator> {set.end(), set.end()}));
+    std::vector<std::size_t> counts;
+    set.count_many(probes.end(), probes.end(), std::back_inserter(counts));
+    EXPECT_TRUE(counts.empty());
+}
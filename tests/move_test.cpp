@@ -0,0 +1,46 @@
+// move construction and move assignment
+
+#include "ads_set_test.h"
+
+#include <string>
+#include <type_traits>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+static_assert(std::is_nothrow_move_constructible_v<ADS_set<int>>);
+static_assert(std::is_nothrow_move_assignable_v<ADS_set<int>>);
+static_assert(std::is_nothrow_move_constructible_v<ADS_set<std::string, 8>>);
+
+TEST(Move, ConstructionTakesTheKeysAndLeavesAnEmptySet) {
+    const std::vector<int> keys {random_keys(2000, 4000, 4)};
+    const std::set<int> expected(keys.begin(), keys.end());
+    ADS_set<int> set(keys.begin(), keys.end());
+    ADS_set<int> moved {std::move(set)};
+    EXPECT_TRUE(same_keys(moved, expected));
+    // the moved from set is empty and usable
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+    set.insert(3);
+    EXPECT_TRUE(same_keys(set, std::set<int> {3}));
+}
+
+TEST(Move, AssignmentReplacesTheKeys) {
+    ADS_set<int> source {1, 2, 3};
+    ADS_set<int> target {7, 8, 9, 10, 11, 12, 13, 14};
+    target = std::move(source);
+    EXPECT_TRUE(same_keys(target, std::set<int> {1, 2, 3}));
+    EXPECT_TRUE(source.empty());
+    source = std::move(target);
+    EXPECT_TRUE(same_keys(source, std::set<int> {1, 2, 3}));
+    source.erase(2);
+    EXPECT_TRUE(same_keys(source, std::set<int> {1, 3}));
+}
+
+TEST(Move, IteratorsFollowTheKeys) {
+    ADS_set<int> set {4, 5, 6};
+    const auto it {set.find(5)};
+    ADS_set<int> moved {std::move(set)};
+    ASSERT_NE(it, moved.end());
+    EXPECT_EQ(*it, 5);
+}
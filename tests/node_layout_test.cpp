@@ -0,0 +1,58 @@
+// the tagged node layout: inserts and erases that split, borrow and merge leaves and internal nodes at every degree
+
+#include "ads_set_test.h"
+
+using ads_set_test::same_keys;
+
+namespace {
+
+    template<typename Set>
+    void churn(const unsigned seed) {
+        std::mt19937 rng {seed};
+        std::uniform_int_distribution<int> key {0, 1999};
+        Set set;
+        std::set<int> expected;
+        for (int round {0}; round < 20000; ++round) {
+            const int k {key(rng)};
+            if (rng() % 3 == 0) {
+                ASSERT_EQ(set.erase(k), expected.erase(k));
+            } else {
+                ASSERT_EQ(set.insert(k).second, expected.insert(k).second);
+            }
+            if (round % 1000 == 0) {
+                ASSERT_TRUE(same_keys(set, expected));
+            }
+        }
+        EXPECT_TRUE(same_keys(set, expected));
+        // empty the set completely and fill it again
+        for (int k {0}; k < 2000; ++k) {
+            ASSERT_EQ(set.erase(k), expected.erase(k));
+        }
+        EXPECT_TRUE(set.empty());
+        for (int k {0}; k < 100; ++k) {
+            set.insert(k);
+        }
+        EXPECT_EQ(set.size(), 100u);
+    }
+
+}
+
+TEST(NodeLayout, ChurnAtEveryDegree) {
+    churn<ADS_set<int, 1>>(7);
+    churn<ADS_set<int, 2>>(8);
+    churn<ADS_set<int, 3>>(9);
+    churn<ADS_set<int, 8>>(10);
+}
+
+TEST(NodeLayout, LookupsAgreeWithStdSet) {
+    ADS_set<int, 1> set;
+    std::set<int> expected;
+    for (int k {0}; k < 3000; k += 3) {
+        set.insert(k);
+        expected.insert(k);
+    }
+    for (int k {-1}; k < 3001; ++k) {
+        ASSERT_EQ(set.count(k), expected.count(k)) << k;
+        ASSERT_EQ(set.find(k) != set.end(), expected.count(k) == 1) << k;
+    }
+}
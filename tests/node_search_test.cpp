@@ -0,0 +1,91 @@
+// the search inside a node, binary for any key and branchless for arithmetic, pointer and enum keys under std::less
+
+#include "ads_set_test.h"
+
+#include <functional>
+#include <string>
+
+using ads_set_test::same_keys;
+
+namespace {
+
+    // every key of a set with gaps between its keys, and every gap, is looked up
+    template<typename Set>
+    void expect_search(const int n) {
+        using key_type = typename Set::key_type;
+        Set set;
+        std::set<key_type, typename Set::key_compare> expected;
+        for (int i {0}; i < n; ++i) {
+            set.insert(static_cast<key_type>(2 * i + 1));
+            expected.insert(static_cast<key_type>(2 * i + 1));
+        }
+        ASSERT_TRUE(same_keys(set, expected));
+        for (int i {0}; i <= 2 * n + 1; ++i) {
+            const key_type key {static_cast<key_type>(i)};
+            ASSERT_EQ(set.count(key), expected.count(key)) << i;
+            const auto lower {set.lower_bound(key)};
+            const auto expected_lower {expected.lower_bound(key)};
+            ASSERT_EQ(lower == set.end(), expected_lower == expected.end()) << i;
+            if (lower != set.end()) {
+                ASSERT_EQ(*lower, *expected_lower) << i;
+            }
+            const auto upper {set.upper_bound(key)};
+            const auto expected_upper {expected.upper_bound(key)};
+            ASSERT_EQ(upper == set.end(), expected_upper == expected.end()) << i;
+            if (upper != set.end()) {
+                ASSERT_EQ(*upper, *expected_upper) << i;
+            }
+        }
+    }
+
+    enum class Colour : int {};
+
+}
+
+TEST(NodeSearch, EveryPositionInWideNodes) {
+    for (const int n: {1, 31, 32, 33, 64, 65, 500}) {
+        expect_search<ADS_set<int, 16>>(n);
+        expect_search<ADS_set<int, 32>>(n);
+        expect_search<ADS_set<long, 5>>(n);
+    }
+}
+
+TEST(NodeSearch, ComparatorsOtherThanLess) {
+    expect_search<ADS_set<int, 16, std::allocator<int>, false, std::greater<int>>>(200);
+    expect_search<ADS_set<int, 16, std::allocator<int>, false, std::less<>>>(200);
+}
+
+TEST(NodeSearch, EnumKeys) {
+    expect_search<ADS_set<Colour, 8>>(100);
+}
+
+TEST(NodeSearch, PointerKeys) {
+    int storage[300];
+    ADS_set<const int *, 8> set;
+    for (int i {0}; i < 300; i += 2) {
+        set.insert(storage + i);
+    }
+    for (int i {0}; i < 300; ++i) {
+        ASSERT_EQ(set.count(storage + i), i % 2 == 0 ? 1u : 0u);
+    }
+    EXPECT_EQ(*set.begin(), storage);
+}
+
+TEST(NodeSearch, StringKeysSearchBinary) {
+    ADS_set<std::string, 16> set;
+    std::set<std::string> expected;
+    for (int i {0}; i < 1000; i += 2) {
+        set.insert(std::to_string(i));
+        expected.insert(std::to_string(i));
+    }
+    for (int i {0}; i < 1000; ++i) {
+        const std::string key {std::to_string(i)};
+        ASSERT_EQ(set.count(key), expected.count(key));
+        const auto lower {set.lower_bound(key)};
+        if (expected.lower_bound(key) == expected.end()) {
+            ASSERT_EQ(lower, set.end());
+        } else {
+            ASSERT_EQ(*lower, *expected.lower_bound(key));
+        }
+    }
+}
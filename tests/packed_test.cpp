@@ -0,0 +1,73 @@
+// pack(): prefix compressed read-only copy of string keys
+
+#include "ads_set_test.h"
+
+#include <string>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    std::string url(const int i) {
+        return "https://example.com/articles/" + std::to_string(i % 37) + "/" + std::to_string(i);
+    }
+
+    template<std::size_t N>
+    void expect_packed(const std::size_t n) {
+        ADS_set<std::string, N> set;
+        std::set<std::string> expected;
+        for (const int key: random_keys(n, static_cast<int>(2 * n + 1), 25)) {
+            set.insert(url(key));
+            expected.insert(url(key));
+        }
+        const auto packed {set.pack()};
+        ASSERT_TRUE(same_keys(packed, expected));
+        for (auto it {packed.begin()}; it != packed.end(); ++it) {
+            ASSERT_EQ(std::string {it.prefix()} + std::string {it.suffix()}, *it);
+        }
+        for (int probe {0}; probe <= static_cast<int>(2 * n + 1); ++probe) {
+            const std::string key {url(probe)};
+            ASSERT_EQ(packed.count(key), expected.count(key));
+            const auto lower {packed.lower_bound(key)};
+            ASSERT_EQ(lower == packed.end(), expected.lower_bound(key) == expected.end());
+            if (lower != packed.end()) {
+                ASSERT_EQ(*lower, *expected.lower_bound(key));
+            }
+            const auto upper {packed.upper_bound(key)};
+            ASSERT_EQ(upper == packed.end(), expected.upper_bound(key) == expected.end());
+            if (upper != packed.end()) {
+                ASSERT_EQ(*upper, *expected.upper_bound(key));
+            }
+        }
+    }
+
+}
+
+TEST(Packed, AgreesWithTheSet) {
+    for (const std::size_t n: {0, 1, 2, 100, 3000}) {
+        expect_packed<1>(n);
+        expect_packed<3>(n);
+        expect_packed<8>(n);
+    }
+}
+
+TEST(Packed, SharedPrefixesTakeLessMemory) {
+    ADS_set<std::string, 8> set;
+    std::size_t bytes {0};
+    for (int i {0}; i < 2000; ++i) {
+        set.insert(url(i));
+        bytes += url(i).size();
+    }
+    EXPECT_LT(set.pack().memory(), bytes);
+}
+
+TEST(Packed, EmptyAndEmptyKeys) {
+    const auto empty {ADS_set<std::string> {}.pack()};
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_EQ(empty.count("x"), 0u);
+    const auto one {ADS_set<std::string> {""}.pack()};
+    EXPECT_EQ(one.count(""), 1u);
+    EXPECT_EQ(one.count("a"), 0u);
+}
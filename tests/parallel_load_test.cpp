@@ -0,0 +1,38 @@
+// sort-and-load of unsorted input by several threads
+
+#include "ads_set_test.h"
+
+#include <string>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+TEST(ParallelLoad, AnyThreadCountAndInputSize) {
+    for (const std::size_t n: {0, 1, 100, 50000}) {
+        const std::vector<int> keys {random_keys(n, static_cast<int>(n / 2 + 1), 21)};
+        const std::set<int> expected(keys.begin(), keys.end());
+        for (const unsigned threads: {1u, 2u, 3u, 8u}) {
+            const ADS_set<int, 3> set(ADS_set<int, 3>::parallel_t {threads}, keys.begin(), keys.end());
+            ASSERT_TRUE(same_keys(set, expected)) << n << " keys, " << threads << " threads";
+        }
+    }
+}
+
+TEST(ParallelLoad, InsertIntoFilledSet) {
+    const std::vector<int> keys {random_keys(20000, 40000, 22)};
+    std::set<int> expected(keys.begin(), keys.end());
+    ADS_set<int, 2, std::allocator<int>, true> set {-5, -4, 100000};
+    set.insert(decltype(set)::parallel_t {4}, keys.begin(), keys.end());
+    expected.insert({-5, -4, 100000});
+    EXPECT_TRUE(same_keys(set, expected));
+    EXPECT_EQ(set.rank(100000), expected.size() - 1);
+}
+
+TEST(ParallelLoad, StringKeys) {
+    std::vector<std::string> keys;
+    for (const int key: random_keys(5000, 3000, 23)) {
+        keys.push_back(std::to_string(key));
+    }
+    const ADS_set<std::string, 4> set(ADS_set<std::string, 4>::parallel_t {3}, keys.begin(), keys.end());
+    EXPECT_TRUE(same_keys(set, std::set<std::string>(keys.begin(), keys.end())));
+}
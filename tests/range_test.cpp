@@ -0,0 +1,57 @@
+// lower_bound, upper_bound, equal_range and range()
+
+#include "ads_set_test.h"
+
+#include <utility>
+
+using ads_set_test::random_keys;
+
+namespace {
+
+    template<typename It>
+    std::vector<int> keys_of(It first, const It last) {
+        return std::vector<int>(first, last);
+    }
+
+}
+
+TEST(Range, BoundsAgreeWithStdSet) {
+    const std::vector<int> keys {random_keys(3000, 9000, 13)};
+    const ADS_set<int, 2> set(keys.begin(), keys.end());
+    const std::set<int> expected(keys.begin(), keys.end());
+    for (int key {-1}; key <= 9001; ++key) {
+        const auto lower {set.lower_bound(key)};
+        const auto upper {set.upper_bound(key)};
+        ASSERT_EQ(lower == set.end() ? -1 : *lower, expected.lower_bound(key) == expected.end() ? -1 : *expected.lower_bound(key));
+        ASSERT_EQ(upper == set.end() ? -1 : *upper, expected.upper_bound(key) == expected.end() ? -1 : *expected.upper_bound(key));
+        const auto [first, last] {set.equal_range(key)};
+        const auto [expected_first, expected_last] {expected.equal_range(key)};
+        ASSERT_EQ(keys_of(first, last), keys_of(expected_first, expected_last));
+    }
+}
+
+TEST(Range, RangeIsHalfOpen) {
+    ADS_set<int, 3> set;
+    for (int key {0}; key < 1000; key += 5) {
+        set.insert(key);
+    }
+    const auto range {set.range(10, 40)};
+    EXPECT_EQ(keys_of(range.begin(), range.end()), (std::vector<int> {10, 15, 20, 25, 30, 35}));
+    const auto between {set.range(11, 14)};
+    EXPECT_TRUE(between.empty());
+    EXPECT_TRUE(set.range(40, 10).empty());
+    EXPECT_TRUE(set.range(20, 20).empty());
+    std::vector<int> tail;
+    for (const int key: set.range(990, 5000)) {
+        tail.push_back(key);
+    }
+    EXPECT_EQ(tail, (std::vector<int> {990, 995}));
+}
+
+TEST(Range, EmptySet) {
+    const ADS_set<int> set;
+    EXPECT_EQ(set.lower_bound(1), set.end());
+    EXPECT_EQ(set.upper_bound(1), set.end());
+    EXPECT_EQ(set.equal_range(1).first, set.end());
+    EXPECT_TRUE(set.range(0, 10).empty());
+}
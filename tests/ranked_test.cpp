@@ -0,0 +1,96 @@
+// rank, select, index_of and distance of Ranked sets, with the subtree sizes kept up by every kind of change
+
+#include "ads_set_test.h"
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    using Set = ADS_set<int, 2, std::allocator<int>, true>;
+
+    // every key and every gap between keys is ranked, every index selected
+    ::testing::AssertionResult ranks_agree(const Set &set, const std::set<int> &expected) {
+        std::size_t index {0};
+        for (const int key: expected) {
+            if (set.rank(key) != index || set.rank(key + 1) != index + 1) {
+                return ::testing::AssertionFailure() << "rank of " << key << " is " << set.rank(key) << ", expected " << index;
+            }
+            const auto selected {set.select(index)};
+            if (selected == set.end() || *selected != key) {
+                return ::testing::AssertionFailure() << "select(" << index << ") is not " << key;
+            }
+            if (set.index_of(selected) != index) {
+                return ::testing::AssertionFailure() << "index_of(select(" << index << ")) is " << set.index_of(selected);
+            }
+            ++index;
+        }
+        if (set.select(index) != set.end() || set.index_of(set.end()) != index) {
+            return ::testing::AssertionFailure() << "select(size()) is not end()";
+        }
+        if (set.distance(set.begin(), set.end()) != static_cast<Set::difference_type>(index)) {
+            return ::testing::AssertionFailure() << "distance(begin(), end()) is " << set.distance(set.begin(), set.end());
+        }
+        return ::testing::AssertionSuccess();
+    }
+
+}
+
+TEST(Ranked, InsertsAndErases) {
+    Set set;
+    std::set<int> expected;
+    std::mt19937 rng {19};
+    for (int round {0}; round < 6000; ++round) {
+        const int key {static_cast<int>(rng() % 1500) * 2};
+        if (rng() % 3 == 0) {
+            set.erase(key);
+            expected.erase(key);
+        } else {
+            set.insert(key);
+            expected.insert(key);
+        }
+        if (round % 500 == 0) {
+            ASSERT_TRUE(ranks_agree(set, expected));
+        }
+    }
+    EXPECT_TRUE(ranks_agree(set, expected));
+}
+
+TEST(Ranked, BulkOperations) {
+    std::vector<int> keys {random_keys(3000, 3000, 20)};
+    for (int &key: keys) {
+        key *= 2;
+    }
+    Set set(keys.begin(), keys.end());
+    std::set<int> expected(keys.begin(), keys.end());
+    EXPECT_TRUE(ranks_agree(set, expected));
+    set.erase(set.lower_bound(1000), set.lower_bound(3000));
+    expected.erase(expected.lower_bound(1000), expected.lower_bound(3000));
+    EXPECT_TRUE(ranks_agree(set, expected));
+    set.erase_if([](const int key) { return key % 6 == 0; });
+    for (auto it {expected.begin()}; it != expected.end();) {
+        it = *it % 6 == 0 ? expected.erase(it) : std::next(it);
+    }
+    EXPECT_TRUE(ranks_agree(set, expected));
+    Set upper {set.split_at(4000)};
+    std::set<int> expected_upper(expected.lower_bound(4000), expected.end());
+    expected.erase(expected.lower_bound(4000), expected.end());
+    EXPECT_TRUE(ranks_agree(set, expected));
+    EXPECT_TRUE(ranks_agree(upper, expected_upper));
+    set.join(std::move(upper));
+    expected.insert(expected_upper.begin(), expected_upper.end());
+    EXPECT_TRUE(ranks_agree(set, expected));
+    const Set copy {set};
+    EXPECT_TRUE(ranks_agree(copy, expected));
+    const Set combined {copy.set_union(Set {1, 3})};
+    expected.insert({1, 3});
+    EXPECT_TRUE(same_keys(combined, expected));
+    EXPECT_TRUE(ranks_agree(combined, expected));
+}
+
+TEST(Ranked, EmptySet) {
+    const Set set;
+    EXPECT_EQ(set.rank(5), 0u);
+    EXPECT_EQ(set.select(0), set.end());
+    EXPECT_EQ(set.index_of(set.end()), 0u);
+}
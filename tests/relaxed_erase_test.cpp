@@ -0,0 +1,77 @@
+// relaxed erase, which leaves underfull leaves alone, and compact(), which brings them back into shape
+
+#include "ads_set_test.h"
+
+using ads_set_test::ascending_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    using Set = ADS_set<int, 3>;
+
+    // leaves are half full on average at least, as they are when none holds fewer than N of its 2N keys
+    bool leaves_in_shape(const Set &set) {
+        const auto stats {set.stats()};
+        return stats.leaf_fill >= 0.5 || stats.height <= 1;
+    }
+
+}
+
+TEST(RelaxedErase, KeysStayCorrectAndCompactRestoresTheShape) {
+    const std::vector<int> keys {ascending_keys(6000)};
+    Set set(keys.begin(), keys.end());
+    std::set<int> expected(keys.begin(), keys.end());
+    set.set_relaxed(true);
+    EXPECT_TRUE(set.relaxed());
+    std::mt19937 rng {26};
+    for (int round {0}; round < 20000; ++round) {
+        const int key {static_cast<int>(rng() % 6000)};
+        if (rng() % 4 == 0) {
+            set.insert(key);
+            expected.insert(key);
+        } else {
+            ASSERT_EQ(set.erase(key), expected.erase(key));
+        }
+    }
+    EXPECT_TRUE(same_keys(set, expected));
+    EXPECT_FALSE(leaves_in_shape(set));
+    set.compact();
+    EXPECT_TRUE(same_keys(set, expected));
+    EXPECT_TRUE(leaves_in_shape(set));
+    EXPECT_TRUE(set.relaxed());
+}
+
+TEST(RelaxedErase, SwitchingOffCompacts) {
+    const std::vector<int> keys {ascending_keys(3000)};
+    Set set(keys.begin(), keys.end());
+    set.set_relaxed(true);
+    std::set<int> expected;
+    for (const int key: keys) {
+        if (key % 5 == 0) {
+            expected.insert(key);
+        } else {
+            set.erase(key);
+        }
+    }
+    EXPECT_FALSE(leaves_in_shape(set));
+    set.set_relaxed(false);
+    EXPECT_FALSE(set.relaxed());
+    EXPECT_TRUE(leaves_in_shape(set));
+    EXPECT_TRUE(same_keys(set, expected));
+    // erasing everything empties the set completely in both modes
+    set.set_relaxed(true);
+    for (const int key: expected) {
+        ASSERT_EQ(set.erase(key), 1u);
+    }
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+    set.insert(1);
+    EXPECT_TRUE(same_keys(set, std::set<int> {1}));
+}
+
+TEST(RelaxedErase, CopiesKeepTheMode) {
+    Set set {1, 2, 3};
+    set.set_relaxed(true);
+    const Set copy {set};
+    EXPECT_TRUE(copy.relaxed());
+}
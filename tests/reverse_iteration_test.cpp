@@ -0,0 +1,45 @@
+// bidirectional iterators and reverse iteration along the leaf chain
+
+#include "ads_set_test.h"
+
+#include <iterator>
+#include <type_traits>
+
+using ads_set_test::random_keys;
+
+static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, std::iterator_traits<ADS_set<int>::iterator>::iterator_category>);
+
+TEST(ReverseIteration, ReverseOrderOfTheKeys) {
+    for (const std::size_t n: {0, 1, 7, 1000}) {
+        const std::vector<int> keys {random_keys(n, 2000, 14)};
+        const ADS_set<int, 2> set(keys.begin(), keys.end());
+        const std::set<int> expected(keys.begin(), keys.end());
+        EXPECT_TRUE(std::equal(set.rbegin(), set.rend(), expected.rbegin(), expected.rend()));
+    }
+}
+
+TEST(ReverseIteration, DecrementFromEndAndBack) {
+    ADS_set<int, 1> set;
+    for (int key {0}; key < 500; ++key) {
+        set.insert(key);
+    }
+    auto it {set.end()};
+    for (int key {499}; key >= 0; --key) {
+        --it;
+        ASSERT_EQ(*it, key);
+    }
+    EXPECT_EQ(it, set.begin());
+    // back and forth across leaf boundaries
+    it = set.find(250);
+    for (int step {0}; step < 20; ++step) {
+        auto next {it};
+        ++next;
+        --next;
+        ASSERT_EQ(next, it);
+        ++it;
+    }
+    EXPECT_EQ(*it, 270);
+    auto post {it--};
+    EXPECT_EQ(*post, 270);
+    EXPECT_EQ(*it, 269);
+}
@@ -0,0 +1,82 @@
+// save() and open_mapped(): saved images read back through the mapped view
+
+#include "ads_set_test.h"
+
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    std::string image_path(const std::string &name) {
+        return ::testing::TempDir() + "ads_set_" + name + ".img";
+    }
+
+    template<typename Key, std::size_t N>
+    void expect_round_trip(const std::size_t n) {
+        std::set<Key> expected;
+        ADS_set<Key, N> set;
+        for (const int key: random_keys(n, static_cast<int>(3 * n + 1), 24)) {
+            set.insert(static_cast<Key>(key));
+            expected.insert(static_cast<Key>(key));
+        }
+        const std::string path {image_path("round_trip")};
+        set.save(path);
+        const auto mapped {ADS_set<Key, N>::open_mapped(path)};
+        ASSERT_TRUE(same_keys(mapped, expected)) << n;
+        for (int probe {-1}; probe <= static_cast<int>(3 * n + 1); ++probe) {
+            const Key key {static_cast<Key>(probe)};
+            ASSERT_EQ(mapped.count(key), expected.count(key));
+            const auto lower {mapped.lower_bound(key)};
+            ASSERT_EQ(lower == mapped.end(), expected.lower_bound(key) == expected.end());
+            if (lower != mapped.end()) {
+                ASSERT_EQ(*lower, *expected.lower_bound(key));
+            }
+            const auto upper {mapped.upper_bound(key)};
+            ASSERT_EQ(upper == mapped.end(), expected.upper_bound(key) == expected.end());
+            ASSERT_EQ(mapped.find(key) == mapped.end(), expected.count(key) == 0);
+        }
+        // the image is the same whether it went to a file or to any other stream
+        std::ostringstream stream;
+        set.save(stream);
+        std::ifstream file {path, std::ios::binary};
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        EXPECT_EQ(contents.str(), stream.str());
+    }
+
+}
+
+TEST(SavedImage, RoundTrip) {
+    for (const std::size_t n: {0, 1, 1000, 20000}) {
+        expect_round_trip<int, 3>(n);
+        expect_round_trip<double, 8>(n);
+        expect_round_trip<std::int64_t, 1>(n);
+    }
+}
+
+TEST(SavedImage, MappedViewMovesAndLoadsBack) {
+    const ADS_set<int> set {5, 3, 1};
+    const std::string path {image_path("moves")};
+    set.save(path);
+    auto mapped {ADS_set<int>::open_mapped(path)};
+    const auto moved {std::move(mapped)};
+    EXPECT_TRUE(same_keys(moved, std::set<int> {1, 3, 5}));
+    const ADS_set<int> loaded(ADS_set<int>::sorted_unique, moved.begin(), moved.end());
+    EXPECT_TRUE(loaded == set);
+}
+
+TEST(SavedImage, RejectsForeignFiles) {
+    const std::string path {image_path("foreign")};
+    ADS_set<int> {1, 2, 3}.save(path);
+    EXPECT_THROW(ADS_set<double>::open_mapped(path), std::runtime_error);
+    std::ofstream {path, std::ios::trunc} << "not an image";
+    EXPECT_THROW(ADS_set<int>::open_mapped(path), std::runtime_error);
+    EXPECT_THROW(ADS_set<int>::open_mapped(image_path("missing_file_that_does_not_exist")), std::system_error);
+}
@@ -0,0 +1,68 @@
+// merge, set_union, set_intersection and set_difference along the leaf chains
+
+#include "ads_set_test.h"
+
+#include <iterator>
+
+using ads_set_test::random_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    using Set = ADS_set<int, 2>;
+
+    std::set<int> apply(const std::set<int> &lhs, const std::set<int> &rhs, const char operation) {
+        std::set<int> result;
+        const auto out {std::inserter(result, result.end())};
+        if (operation == '|') {
+            std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), out);
+        } else if (operation == '&') {
+            std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), out);
+        } else {
+            std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), out);
+        }
+        return result;
+    }
+
+}
+
+TEST(SetAlgebra, AgreesWithTheStandardAlgorithms) {
+    for (const std::size_t n: {0, 1, 50, 3000}) {
+        for (const std::size_t m: {0, 1, 2000}) {
+            const std::vector<int> left_keys {random_keys(n, 4000, 17)};
+            const std::vector<int> right_keys {random_keys(m, 4000, 18)};
+            const Set lhs(left_keys.begin(), left_keys.end());
+            const Set rhs(right_keys.begin(), right_keys.end());
+            const std::set<int> left(left_keys.begin(), left_keys.end());
+            const std::set<int> right(right_keys.begin(), right_keys.end());
+            EXPECT_TRUE(same_keys(lhs.set_union(rhs), apply(left, right, '|')));
+            EXPECT_TRUE(same_keys(lhs.set_intersection(rhs), apply(left, right, '&')));
+            EXPECT_TRUE(same_keys(lhs.set_difference(rhs), apply(left, right, '-')));
+            // the operands stay as they were
+            EXPECT_TRUE(same_keys(lhs, left));
+            EXPECT_TRUE(same_keys(rhs, right));
+        }
+    }
+}
+
+TEST(SetAlgebra, MergeMovesWhatIsMissing) {
+    Set target {1, 2, 3, 4};
+    Set source {3, 4, 5, 6};
+    target.merge(source);
+    EXPECT_TRUE(same_keys(target, std::set<int> {1, 2, 3, 4, 5, 6}));
+    // like std::set::merge, the keys target had already stay in source
+    EXPECT_TRUE(same_keys(source, std::set<int> {3, 4}));
+    target.merge(target);
+    EXPECT_EQ(target.size(), 6u);
+    target.merge(Set {0, 7});
+    EXPECT_TRUE(same_keys(target, std::set<int> {0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST(SetAlgebra, ResultsAreRegularSets) {
+    const Set lhs {1, 3, 5, 7, 9, 11, 13};
+    const Set rhs {2, 3, 5, 8, 13};
+    Set result {lhs.set_union(rhs)};
+    result.insert(100);
+    result.erase(1);
+    EXPECT_TRUE(same_keys(result, std::set<int> {2, 3, 5, 7, 8, 9, 11, 13, 100}));
+}
@@ -0,0 +1,83 @@
+// the vectorized node search for arithmetic keys, with keys at both ends of their range
+
+#include "ads_set_test.h"
+
+#include <cstdint>
+#include <limits>
+
+using ads_set_test::same_keys;
+
+namespace {
+
+    // the extremes of key_type and a run around zero, all looked up in sets of several node widths
+    template<typename Key, std::size_t N>
+    void expect_search() {
+        using limits = std::numeric_limits<Key>;
+        std::vector<Key> keys {limits::lowest(), limits::max(), static_cast<Key>(limits::lowest() + 1), static_cast<Key>(limits::max() - 1)};
+        for (int i {0}; i < 100; ++i) {
+            keys.push_back(static_cast<Key>(std::is_signed_v<Key> ? i - 50 : i));
+        }
+        const std::set<Key> all(keys.begin(), keys.end());
+        ADS_set<Key, N> set;
+        std::set<Key> expected;
+        std::size_t i {0};
+        for (const Key key: all) {
+            // every other key goes in, the rest are misses
+            if (i++ % 2 == 0) {
+                set.insert(key);
+                expected.insert(key);
+            }
+        }
+        ASSERT_TRUE(same_keys(set, expected));
+        for (const Key key: all) {
+            ASSERT_EQ(set.count(key), expected.count(key));
+            const auto lower {set.lower_bound(key)};
+            const auto expected_lower {expected.lower_bound(key)};
+            ASSERT_EQ(lower == set.end(), expected_lower == expected.end());
+            if (lower != set.end()) {
+                ASSERT_EQ(*lower, *expected_lower);
+            }
+            const auto upper {set.upper_bound(key)};
+            const auto expected_upper {expected.upper_bound(key)};
+            ASSERT_EQ(upper == set.end(), expected_upper == expected.end());
+            if (upper != set.end()) {
+                ASSERT_EQ(*upper, *expected_upper);
+            }
+        }
+    }
+
+    template<typename Key>
+    void expect_search_at_all_widths() {
+        expect_search<Key, 1>();
+        expect_search<Key, 4>();
+        expect_search<Key, 16>();
+        expect_search<Key, 40>();
+    }
+
+}
+
+TEST(SimdSearch, SignedIntegers) {
+    expect_search_at_all_widths<std::int8_t>();
+    expect_search_at_all_widths<std::int16_t>();
+    expect_search_at_all_widths<std::int32_t>();
+    expect_search_at_all_widths<std::int64_t>();
+}
+
+TEST(SimdSearch, UnsignedIntegers) {
+    expect_search_at_all_widths<std::uint8_t>();
+    expect_search_at_all_widths<std::uint16_t>();
+    expect_search_at_all_widths<std::uint32_t>();
+    expect_search_at_all_widths<std::uint64_t>();
+}
+
+TEST(SimdSearch, FloatingPoint) {
+    expect_search_at_all_widths<float>();
+    expect_search_at_all_widths<double>();
+}
+
+TEST(SimdSearch, NegativeZeroFindsZero) {
+    ADS_set<double, 8> set {-1.0, 0.0, 1.0};
+    EXPECT_EQ(set.count(-0.0), 1u);
+    EXPECT_EQ(*set.lower_bound(-0.0), 0.0);
+    EXPECT_EQ(*set.upper_bound(-0.0), 1.0);
+}
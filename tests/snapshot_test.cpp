@@ -0,0 +1,148 @@
+// copy-on-write snapshots: a snapshot keeps its keys through every change of the set it was taken from
+
+#include "ads_set_test.h"
+
+#include <functional>
+#include <stdexcept>
+
+using ads_set_test::ascending_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    using Set = ADS_set<int, 2>;
+
+    const std::vector<int> keys {ascending_keys(2000)};
+    const std::set<int> expected(keys.begin(), keys.end());
+
+    // changes the set in one way after a snapshot was taken; the snapshot must still hold all keys
+    void expect_frozen(const std::function<void(Set &, std::set<int> &)> &change) {
+        Set set(keys.begin(), keys.end());
+        const auto snapshot {set.snapshot()};
+        std::set<int> changed {expected};
+        change(set, changed);
+        EXPECT_TRUE(same_keys(set, changed));
+        EXPECT_TRUE(same_keys(snapshot, expected));
+        EXPECT_EQ(snapshot.count(1999), 1u);
+        EXPECT_EQ(*snapshot.lower_bound(1000), 1000);
+    }
+
+}
+
+TEST(Snapshot, SurvivesPointChanges) {
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        for (int key {0}; key < 2000; key += 3) {
+            set.erase(key);
+            changed.erase(key);
+        }
+        for (int key {2000}; key < 2500; ++key) {
+            set.insert(key);
+            changed.insert(key);
+        }
+    });
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        auto it {set.find(500)};
+        for (int i {0}; i < 100; ++i) {
+            changed.erase(*it);
+            it = set.erase(it);
+        }
+        set.insert(set.end(), 5000);
+        changed.insert(5000);
+    });
+}
+
+TEST(Snapshot, SurvivesBulkChanges) {
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        set.erase(set.lower_bound(100), set.lower_bound(1900));
+        changed.erase(changed.lower_bound(100), changed.lower_bound(1900));
+    });
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        Set upper {set.split_at(700)};
+        upper.insert(3000);
+        set.join(std::move(upper));
+        changed.insert(3000);
+    });
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        set.merge(Set {-1, 5000});
+        changed.insert({-1, 5000});
+    });
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        set.clear();
+        changed.clear();
+    });
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        set = Set {1, 2};
+        changed = {1, 2};
+    });
+}
+
+TEST(Snapshot, EraseIfOnASharedTree) {
+    expect_frozen([](Set &set, std::set<int> &changed) {
+        EXPECT_EQ(set.erase_if([](const int key) { return key % 2 == 0; }), 1000u);
+        for (auto it {changed.begin()}; it != changed.end();) {
+            it = *it % 2 == 0 ? changed.erase(it) : std::next(it);
+        }
+    });
+    // nothing matches: no keys are copied and nothing leaks
+    expect_frozen([](Set &set, std::set<int> &) { EXPECT_EQ(set.erase_if([](const int key) { return key < 0; }), 0u); });
+    // a throwing predicate leaves the set as it was
+    expect_frozen([](Set &set, std::set<int> &) {
+        const auto throws_late {[](const int key) -> bool {
+            if (key == 1500) {
+                throw std::runtime_error {"predicate"};
+            }
+            return key % 3 == 0;
+        }};
+        EXPECT_THROW(set.erase_if(throws_late), std::runtime_error);
+    });
+}
+
+TEST(Snapshot, BulkLoadIntoAnEmptiedSet) {
+    // erasing the last key leaves the root leaf, which the snapshot shares
+    const std::vector<int> more {ascending_keys(500)};
+    for (const bool sorted_unique: {false, true}) {
+        Set set;
+        set.insert(1);
+        set.erase(1);
+        const auto snapshot {set.snapshot()};
+        if (sorted_unique) {
+            set.insert(Set::sorted_unique, more.begin(), more.end());
+        } else {
+            set.insert(more.begin(), more.end());
+        }
+        EXPECT_TRUE(same_keys(set, std::set<int>(more.begin(), more.end())));
+        EXPECT_EQ(snapshot.size(), 0u);
+        EXPECT_EQ(snapshot.begin(), snapshot.end());
+        for (const int key: more) {
+            ASSERT_EQ(snapshot.count(key), 0u) << key;
+        }
+    }
+}
+
+TEST(Snapshot, OutlivesTheSetAndIsCopyable) {
+    std::vector<Set::Snapshot> snapshots;
+    {
+        Set set(keys.begin(), keys.end());
+        snapshots.push_back(set.snapshot());
+        set.erase(0);
+        snapshots.push_back(set.snapshot());
+        set.erase(1);
+    }
+    const Set::Snapshot copy {snapshots[1]};
+    snapshots.erase(snapshots.begin() + 1);
+    EXPECT_TRUE(same_keys(snapshots[0], expected));
+    std::set<int> without_zero {expected};
+    without_zero.erase(0);
+    EXPECT_TRUE(same_keys(copy, without_zero));
+}
+
+TEST(Snapshot, PoolAllocatedSet) {
+    ADS_set<int, 3, ADS_pool_allocator<int>> set(keys.begin(), keys.end());
+    const auto snapshot {set.snapshot()};
+    for (int key {0}; key < 2000; key += 2) {
+        set.erase(key);
+    }
+    set.erase(set.lower_bound(1000), set.end());
+    EXPECT_TRUE(same_keys(snapshot, expected));
+    EXPECT_EQ(set.size(), 500u);
+}
@@ -0,0 +1,83 @@
+// split_at and join of whole trees
+
+#include "ads_set_test.h"
+
+using ads_set_test::ascending_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    template<typename Set>
+    void expect_split_and_join(const int n, const int at) {
+        const std::vector<int> keys {ascending_keys(static_cast<std::size_t>(n))};
+        Set lower(keys.begin(), keys.end());
+        Set upper {lower.split_at(at)};
+        std::set<int> expected_lower;
+        std::set<int> expected_upper;
+        for (const int key: keys) {
+            (key < at ? expected_lower : expected_upper).insert(key);
+        }
+        ASSERT_TRUE(same_keys(lower, expected_lower)) << n << " at " << at;
+        ASSERT_TRUE(same_keys(upper, expected_upper)) << n << " at " << at;
+        // both parts are full sets on their own
+        if (!expected_upper.empty()) {
+            ASSERT_EQ(upper.erase(*expected_upper.begin()), 1u);
+            upper.insert(*expected_upper.begin());
+        }
+        lower.insert(-1);
+        ASSERT_EQ(lower.erase(-1), 1u);
+        lower.join(std::move(upper));
+        EXPECT_TRUE(upper.empty());
+        ASSERT_TRUE(same_keys(lower, std::set<int>(keys.begin(), keys.end()))) << n << " at " << at;
+        lower.insert(n);
+        EXPECT_EQ(*lower.rbegin(), n);
+    }
+
+}
+
+TEST(SplitJoin, EverySplitPoint) {
+    for (const int n: {0, 1, 2, 13, 100, 1000}) {
+        for (const int at: {-1, 0, 1, n / 2, n - 1, n, n + 1}) {
+            expect_split_and_join<ADS_set<int, 1>>(n, at);
+            expect_split_and_join<ADS_set<int, 3>>(n, at);
+            expect_split_and_join<ADS_set<int, 3, std::allocator<int>, true>>(n, at);
+        }
+    }
+}
+
+TEST(SplitJoin, JoinTreesOfDifferentHeights) {
+    for (const int small: {1, 5, 50}) {
+        ADS_set<int, 2> tall;
+        ADS_set<int, 2> short_one;
+        std::set<int> expected;
+        for (int key {0}; key < 3000; ++key) {
+            tall.insert(key);
+            expected.insert(key);
+        }
+        for (int key {3000}; key < 3000 + small; ++key) {
+            short_one.insert(key);
+            expected.insert(key);
+        }
+        ADS_set<int, 2> copy {short_one};
+        tall.join(std::move(short_one));
+        EXPECT_TRUE(same_keys(tall, expected));
+        // the other way round: the lower set is the short one
+        ADS_set<int, 2> rest {tall.split_at(3000)};
+        copy.clear();
+        for (int key {-small}; key < 0; ++key) {
+            copy.insert(key);
+            expected.insert(key);
+        }
+        copy.join(std::move(tall));
+        copy.join(std::move(rest));
+        EXPECT_TRUE(same_keys(copy, expected));
+    }
+}
+
+TEST(SplitJoin, JoinWithPoolAllocators) {
+    using Set = ADS_set<int, 3, ADS_pool_allocator<int>>;
+    Set lower {1, 2, 3};
+    Set upper {10, 11, 12};
+    lower.join(std::move(upper));
+    EXPECT_TRUE(same_keys(lower, std::set<int> {1, 2, 3, 10, 11, 12}));
+}
@@ -0,0 +1,54 @@
+// the ADS_SET_STATS counters behind stats(), built with ADS_SET_STATS=1
+
+#include "ads_set_test.h"
+
+static_assert(ADS_SET_STATS, "stats_counters_test.cpp is built with ADS_SET_STATS=1");
+
+TEST(StatsCounters, CountSplitsMergesAndLookups) {
+    ADS_set<int, 2> set;
+    for (int key {0}; key < 2000; ++key) {
+        set.insert(key * 7 % 2000);
+    }
+    const auto filled {set.stats()};
+    EXPECT_GT(filled.splits, 0u);
+    EXPECT_GE(filled.lookups, 2000u);
+    EXPECT_GE(filled.comparisons, filled.lookups);
+    for (int key {0}; key < 2000; key += 2) {
+        set.erase(key);
+    }
+    const auto erased {set.stats()};
+    EXPECT_GT(erased.merges + erased.borrows, 0u);
+    set.reset_stats();
+    EXPECT_EQ(set.stats().lookups, 0u);
+    set.count(1);
+    EXPECT_EQ(set.stats().lookups, 1u);
+    // copies start from zero
+    const ADS_set<int, 2> copy {set};
+    EXPECT_EQ(copy.stats().lookups, 0u);
+}
+
+TEST(StatsCounters, SwitchedOff) {
+    ADS_set<int> set {1, 2, 3};
+    set.reset_stats();
+    set.set_stats(false);
+    set.count(1);
+    set.insert(4);
+    EXPECT_EQ(set.stats().lookups, 0u);
+    set.set_stats(true);
+    set.count(1);
+    EXPECT_EQ(set.stats().lookups, 1u);
+}
+
+TEST(StatsCounters, ConcurrentSetDoesNotCount) {
+    ADS_concurrent_set<int> set;
+    for (int key {0}; key < 100; ++key) {
+        set.insert(key);
+    }
+    for (int key {0}; key < 100; ++key) {
+        ASSERT_EQ(set.count(key), 1u);
+    }
+    const auto stats {set.read([](const auto &s) { return s.stats(); })};
+    EXPECT_EQ(stats.lookups, 0u);
+    EXPECT_EQ(stats.splits, 0u);
+    EXPECT_EQ(stats.size, 100u);
+}
@@ -0,0 +1,47 @@
+// stats(): the shape of the tree, which needs no ADS_SET_STATS
+
+#include "ads_set_test.h"
+
+#include <numeric>
+
+using ads_set_test::ascending_keys;
+
+TEST(Stats, EmptySet) {
+    const auto stats {ADS_set<int> {}.stats()};
+    EXPECT_EQ(stats.size, 0u);
+    EXPECT_EQ(stats.height, 0u);
+    EXPECT_EQ(stats.bytes, 0u);
+    EXPECT_EQ(stats.leaf_fill, 0.0);
+}
+
+TEST(Stats, ShapeOfALoadedTree) {
+    const std::vector<int> keys {ascending_keys(1000)};
+    // full leaves of 2N = 4 keys, internal nodes of 5 children
+    const ADS_set<int, 2> set(ADS_set<int, 2>::sorted_unique, keys.begin(), keys.end(), 4);
+    const auto stats {set.stats()};
+    EXPECT_EQ(stats.size, 1000u);
+    ASSERT_EQ(stats.nodes_per_level.size(), stats.height);
+    EXPECT_EQ(stats.nodes_per_level.front(), 1u);
+    EXPECT_EQ(stats.nodes_per_level.back(), 250u);
+    EXPECT_DOUBLE_EQ(stats.leaf_fill, 1.0);
+    EXPECT_GT(stats.bytes, 0u);
+    // every level holds more nodes than the one above it
+    for (std::size_t level {1}; level < stats.nodes_per_level.size(); ++level) {
+        EXPECT_GT(stats.nodes_per_level[level], stats.nodes_per_level[level - 1]);
+    }
+    const ADS_set<int, 2> single {1, 2, 3};
+    EXPECT_EQ(single.stats().height, 1u);
+    EXPECT_EQ(single.stats().nodes_per_level, (std::vector<std::size_t> {1}));
+}
+
+TEST(Stats, CountersStayZeroWithoutAdsSetStats) {
+    ADS_set<int, 1> set;
+    for (int key {0}; key < 1000; ++key) {
+        set.insert(key);
+    }
+    set.count(5);
+    const auto stats {set.stats()};
+    EXPECT_EQ(stats.splits, 0u);
+    EXPECT_EQ(stats.lookups, 0u);
+    EXPECT_EQ(stats.comparisons, 0u);
+}
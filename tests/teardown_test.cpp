@@ -0,0 +1,108 @@
+// clear(), clear_async() and destruction: deep and wide trees are freed completely, and clear() allocates nothing
+
+#include "ads_set_test.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+using ads_set_test::ascending_keys;
+using ads_set_test::same_keys;
+
+namespace {
+
+    struct Tally {
+            long allocations {0};
+            long live {0};
+    };
+
+    // std::allocator that counts allocate() calls and the objects not given back yet, in a Tally its copies share
+    template<typename T>
+    struct TallyAllocator {
+            using value_type = T;
+
+            std::shared_ptr<Tally> tally;
+
+            TallyAllocator(): tally {std::make_shared<Tally>()} {}
+
+            template<typename U>
+            TallyAllocator(const TallyAllocator<U> &other) noexcept: tally {other.tally} {}
+
+            T *allocate(const std::size_t n) {
+                ++tally->allocations;
+                tally->live += static_cast<long>(n);
+                return std::allocator<T> {}.allocate(n);
+            }
+
+            void deallocate(T *p, const std::size_t n) noexcept {
+                tally->live -= static_cast<long>(n);
+                std::allocator<T> {}.deallocate(p, n);
+            }
+
+            template<typename U>
+            bool operator==(const TallyAllocator<U> &rhs) const noexcept {
+                return tally == rhs.tally;
+            }
+
+            template<typename U>
+            bool operator!=(const TallyAllocator<U> &rhs) const noexcept {
+                return tally != rhs.tally;
+            }
+    };
+
+}
+
+TEST(Teardown, ClearAllocatesNothingAndFreesEverything) {
+    const TallyAllocator<int> allocator;
+    ADS_set<int, 1, TallyAllocator<int>> set {allocator};
+    for (int key {0}; key < 50000; ++key) {
+        set.insert(key * 7919 % 50000);
+    }
+    const long allocations {allocator.tally->allocations};
+    set.clear();
+    EXPECT_EQ(allocator.tally->allocations, allocations);
+    EXPECT_EQ(allocator.tally->live, 0);
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.begin(), set.end());
+    set.insert(1);
+    EXPECT_TRUE(same_keys(set, std::set<int> {1}));
+}
+
+TEST(Teardown, DestructionOfDeepTrees) {
+    const TallyAllocator<int> allocator;
+    {
+        // N = 1 gives the deepest tree for the keys
+        ADS_set<int, 1, TallyAllocator<int>> set {allocator};
+        for (int key {0}; key < 100000; ++key) {
+            set.insert(key);
+        }
+        const ADS_set<int, 1, TallyAllocator<int>> copy {set};
+        set.erase(set.lower_bound(1000), set.lower_bound(90000));
+    }
+    EXPECT_EQ(allocator.tally->live, 0);
+}
+
+TEST(Teardown, ClearWithSnapshots) {
+    const std::vector<int> keys {ascending_keys(5000)};
+    ADS_set<int, 2> set(keys.begin(), keys.end());
+    const auto snapshot {set.snapshot()};
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(same_keys(snapshot, std::set<int>(keys.begin(), keys.end())));
+}
+
+TEST(Teardown, ClearAsync) {
+    const std::vector<int> keys {ascending_keys(20000)};
+    ADS_set<int, 2> set(keys.begin(), keys.end());
+    auto freed {set.clear_async()};
+    EXPECT_TRUE(set.empty());
+    set.insert(3);
+    EXPECT_TRUE(same_keys(set, std::set<int> {3}));
+    freed.wait();
+    // a set with an allocator that has state is cleared right away
+    ADS_set<int, 3, ADS_pool_allocator<int>> pooled(keys.begin(), keys.end());
+    auto done {pooled.clear_async()};
+    EXPECT_EQ(done.wait_for(std::chrono::seconds {0}), std::future_status::ready);
+    EXPECT_TRUE(pooled.empty());
+    EXPECT_EQ(ADS_set<int> {}.clear_async().wait_for(std::chrono::seconds {0}), std::future_status::ready);
+}
@@ -0,0 +1,71 @@
+// lookups with any type a transparent key_compare compares against keys, without building a key
+
+#include "ads_set_test.h"
+
+#include <string>
+#include <string_view>
+
+namespace {
+
+    // counts how often it is built from a string, so that a lookup that builds a temporary key shows
+    struct Name {
+            static inline int built {0};
+
+            std::string text;
+
+            Name() = default;
+            explicit Name(const std::string_view from): text {from} {
+                ++built;
+            }
+    };
+
+    struct NameLess {
+            using is_transparent = void;
+
+            bool operator()(const Name &lhs, const Name &rhs) const {
+                return lhs.text < rhs.text;
+            }
+            bool operator()(const Name &lhs, const std::string_view rhs) const {
+                return lhs.text < rhs;
+            }
+            bool operator()(const std::string_view lhs, const Name &rhs) const {
+                return lhs < rhs.text;
+            }
+    };
+
+    using NameSet = ADS_set<Name, 3, std::allocator<Name>, false, NameLess>;
+
+}
+
+TEST(TransparentLookup, NoTemporaryKeys) {
+    NameSet set;
+    for (int i {0}; i < 1000; i += 2) {
+        set.insert(Name {std::to_string(1000 + i)});
+    }
+    const int built {Name::built};
+    for (int i {0}; i < 1000; ++i) {
+        const std::string text {std::to_string(1000 + i)};
+        const std::string_view key {text};
+        const bool present {i % 2 == 0};
+        ASSERT_EQ(set.count(key), present ? 1u : 0u);
+        ASSERT_EQ(set.contains(key), present);
+        ASSERT_EQ(set.find(key) != set.end(), present);
+        const auto lower {set.lower_bound(key)};
+        if (i < 998) {
+            ASSERT_EQ(lower->text, std::to_string(1000 + i + (present ? 0 : 1)));
+        }
+        const auto [first, last] {set.equal_range(key)};
+        ASSERT_EQ(std::distance(first, last), present ? 1 : 0);
+        ASSERT_EQ(set.upper_bound(key) == set.end(), i >= 998);
+    }
+    EXPECT_EQ(Name::built, built);
+}
+
+TEST(TransparentLookup, StdLessOfVoid) {
+    ADS_set<std::string, 3, std::allocator<std::string>, false, std::less<>> set {"apple", "banana", "cherry"};
+    const std::string_view key {"banana split", 6};
+    EXPECT_EQ(set.count(key), 1u);
+    EXPECT_EQ(*set.find("cherry"), "cherry");
+    EXPECT_EQ(*set.lower_bound(std::string_view {"b"}), "banana");
+    EXPECT_EQ(set.count("durian"), 0u);
+}